@@ -0,0 +1,67 @@
+#include "pch.h"
+#include "AlphaMask.h"
+
+#include <utility>
+
+namespace rc {
+
+	AlphaMask::AlphaMask() :
+		width(0),
+		height(0),
+		words_per_column(0)
+	{
+	}
+
+	AlphaMask::AlphaMask(const Texture& texture) :
+		width(texture.width),
+		height(texture.height),
+		words_per_column((texture.height + BITS_PER_WORD - 1) / BITS_PER_WORD),
+		bits((size_t) texture.width * words_per_column, 0),
+		column_spans(texture.width, ColumnSpan{ 1, 0 })
+	{
+		constexpr uint32_t half_alpha = 128;
+
+		column_first_run.reserve(width + 1);
+
+		for (uint16_t x = 0; x < width; ++x) {
+			ColumnSpan& span = column_spans[x];
+			column_first_run.push_back((uint32_t) runs.size());
+			bool in_run = false;
+
+			for (uint16_t y = 0; y < height; ++y) {
+				const uint32_t alpha = texture.pixel(x, y) >> 24;
+				if (alpha == 0) {
+					in_run = false;
+					continue;
+				}
+
+				if (!in_run)
+					runs.push_back(VisibleRun{ y, y });
+				runs.back().end_row = y + 1;
+				in_run = true;
+
+				if (alpha < half_alpha)
+					continue;
+
+				bits[(size_t) x * words_per_column + y / BITS_PER_WORD] |= uint64_t(1) << (y % BITS_PER_WORD);
+
+				if (span.first_opaque > span.last_opaque)
+					span.first_opaque = y;
+				span.last_opaque = y;
+
+				if (!in_run)
+					runs.push_back(VisibleRun{ y, y });
+				runs.back().end_row = y + 1;
+				in_run = true;
+			}
+		}
+
+		column_first_run.push_back((uint32_t) runs.size());
+	}
+
+
+	void AlphaMasks::set(const TextureIndex texture, AlphaMask mask)
+	{
+		masks[slot(texture)] = std::move(mask);
+	}
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Canvas.h"
+#include "Texture.h"
+
+namespace rc {
+
+	/** Which pixels of a texture can be seen (and hit), 1 bit per pixel.
+
+	Extracted once, when the texture is loaded. After that the graphics API is not needed to know if a bullet
+	hits the sprite or goes through a transparent pixel. Like the original test on the image, pixels with an
+	alpha below 128 (half-way in the scale) are transparent.
+
+	The bits are stored column by column, since the projection and the hit tests work one column at a time.
+
+	Each column is also described as a list of visible runs (sequences of pixels with any alpha above 0). The sprites
+	are mostly transparent around the silhouette: drawing only the runs saves most of the texels. The runs keep the
+	semi-transparent pixels of the soft edges, so the image is the same as drawing the whole column.
+	*/
+	class AlphaMask {
+	public:
+		/** First and last opaque row of a column. If the column is fully transparent, first > last. */
+		struct ColumnSpan {
+			uint16_t first_opaque;
+			uint16_t last_opaque;
+		};
+
+		/** Consecutive pixels of a column that are not fully transparent, from the first_row up to end_row (excluded). */
+		struct VisibleRun {
+			uint16_t first_row;
+			uint16_t end_row;
+		};
+
+		/** The runs of a column, to use in a range for. */
+		struct RunRange {
+			const VisibleRun* first;
+			const VisibleRun* last;
+
+			const VisibleRun* begin() const noexcept { return first; }
+			const VisibleRun* end() const noexcept { return last; }
+			bool empty() const noexcept { return first == last; }
+		};
+
+		/** A mask with no texture, where everything is opaque. Used when there is no image at all (e. g. in the tests). */
+		AlphaMask();
+		explicit AlphaMask(const Texture& texture);
+
+		/** Coordinates outside the mask are transparent. */
+		bool opaque(const uint16_t x, const uint16_t y) const noexcept;
+
+		/** Summary of the column, to skip the completely transparent ones or to clip the visible part. */
+		ColumnSpan column_span(const uint16_t x) const noexcept;
+		bool transparent_column(const uint16_t x) const noexcept;
+
+		/** Top to bottom. Empty for fully transparent columns (and for the columns outside the mask). */
+		RunRange visible_runs(const uint16_t x) const noexcept;
+
+		uint16_t width;
+		uint16_t height;
+
+	private:
+		static constexpr uint8_t BITS_PER_WORD = 64;
+
+		uint16_t words_per_column;
+		std::vector<uint64_t> bits;
+		std::vector<ColumnSpan> column_spans;
+
+		/** All the runs, column after column. The runs of column x go from column_first_run[x] to column_first_run[x + 1]. */
+		std::vector<VisibleRun> runs;
+		std::vector<uint32_t> column_first_run;
+
+		/** The only run of every column in a mask without texture. */
+		static constexpr VisibleRun ALL_ROWS = { 0, UINT16_MAX };
+	};
+
+
+	/** The masks of all the textures, with direct addressing by TextureIndex. */
+	class AlphaMasks {
+	public:
+		void set(const TextureIndex texture, AlphaMask mask);
+		const AlphaMask& of(const TextureIndex texture) const noexcept;
+
+	private:
+		/** The indices are single bits, there can not be more than 8 of them. */
+		std::array<AlphaMask, 8> masks;
+
+		static uint8_t slot(const TextureIndex texture) noexcept;
+	};
+
+
+	inline bool AlphaMask::opaque(const uint16_t x, const uint16_t y) const noexcept
+	{
+		if (bits.empty())
+			return true;
+
+		if (x >= width || y >= height)
+			return false;
+
+		const uint64_t word = bits[(size_t) x * words_per_column + y / BITS_PER_WORD];
+		return (word >> (y % BITS_PER_WORD)) & 1;
+	}
+
+	inline AlphaMask::ColumnSpan AlphaMask::column_span(const uint16_t x) const noexcept
+	{
+		if (column_spans.empty())
+			return ColumnSpan{ 0, (uint16_t)(height - 1) };
+
+		if (x >= width)
+			return ColumnSpan{ 1, 0 };
+
+		return column_spans[x];
+	}
+
+	inline bool AlphaMask::transparent_column(const uint16_t x) const noexcept
+	{
+		const ColumnSpan span = column_span(x);
+		return span.first_opaque > span.last_opaque;
+	}
+
+	inline AlphaMask::RunRange AlphaMask::visible_runs(const uint16_t x) const noexcept
+	{
+		if (column_first_run.empty())
+			return RunRange{ &ALL_ROWS, &ALL_ROWS + 1 };
+
+		if (x >= width)
+			return RunRange{ nullptr, nullptr };
+
+		const VisibleRun* all_runs = runs.data();
+		return RunRange{ all_runs + column_first_run[x], all_runs + column_first_run[x + 1] };
+	}
+
+	inline const AlphaMask& AlphaMasks::of(const TextureIndex texture) const noexcept
+	{
+		return masks[slot(texture)];
+	}
+
+	inline uint8_t AlphaMasks::slot(const TextureIndex texture) noexcept
+	{
+		uint8_t bit = (uint8_t) texture;
+		uint8_t position = 0;
+		while (bit > 1) {
+			bit >>= 1;
+			++position;
+		}
+		return position;
+	}
+}
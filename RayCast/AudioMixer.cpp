@@ -0,0 +1,212 @@
+#include "pch.h"
+#include "AudioMixer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// SSE2 is always there on x64, it must be enabled on 32 bits.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RC_MIXER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace rc {
+
+	static constexpr uint8_t GAIN_FRACTION_BITS = 14;
+
+	static int16_t fixed_point_gain(const float gain) noexcept {
+		constexpr float one = 1 << GAIN_FRACTION_BITS;
+		return (int16_t) std::lround(std::min(std::max(gain, 0.0f), 32767 / one) * one);
+	}
+
+	/** Adds the samples, scaled by the gains of their channel, to the accumulator. The count is even: the
+	samples start and end on a whole frame, and the even ones are on the left. */
+	static void add_scaled(const int16_t* samples, const int16_t left_gain, const int16_t right_gain,
+		int32_t* accumulator, const uint32_t count) noexcept
+	{
+		uint32_t i = 0;
+
+#ifdef RC_MIXER_SSE2
+		const __m128i gains = _mm_set_epi16(right_gain, left_gain, right_gain, left_gain, right_gain, left_gain, right_gain, left_gain);
+
+		for (; i + 8 <= count; i += 8) {
+			// The full 32 bits products, from their low and high halves.
+			const __m128i s = _mm_loadu_si128((const __m128i*) (samples + i));
+			const __m128i low = _mm_mullo_epi16(s, gains);
+			const __m128i high = _mm_mulhi_epi16(s, gains);
+			const __m128i first_products = _mm_srai_epi32(_mm_unpacklo_epi16(low, high), GAIN_FRACTION_BITS);
+			const __m128i last_products = _mm_srai_epi32(_mm_unpackhi_epi16(low, high), GAIN_FRACTION_BITS);
+
+			__m128i* sums = (__m128i*) (accumulator + i);
+			_mm_storeu_si128(sums, _mm_add_epi32(_mm_loadu_si128(sums), first_products));
+			_mm_storeu_si128(sums + 1, _mm_add_epi32(_mm_loadu_si128(sums + 1), last_products));
+		}
+#endif
+
+		// Whatever the vector loop left, or everything without SSE2. Same operations, same results.
+		for (; i < count; ++i) {
+			const int32_t gain = (i % 2 == 0) ? left_gain : right_gain;
+			accumulator[i] += (samples[i] * gain) >> GAIN_FRACTION_BITS;
+		}
+	}
+
+	static void saturate(const int32_t* accumulator, int16_t* samples, const uint32_t count) noexcept
+	{
+		uint32_t i = 0;
+
+#ifdef RC_MIXER_SSE2
+		for (; i + 8 <= count; i += 8) {
+			const __m128i first = _mm_loadu_si128((const __m128i*) (accumulator + i));
+			const __m128i last = _mm_loadu_si128((const __m128i*) (accumulator + i + 4));
+			_mm_storeu_si128((__m128i*) (samples + i), _mm_packs_epi32(first, last));
+		}
+#endif
+
+		for (; i < count; ++i)
+			samples[i] = (int16_t) std::min(std::max(accumulator[i], (int32_t) INT16_MIN), (int32_t) INT16_MAX);
+	}
+
+
+	uint32_t AudioClip::frames() const noexcept
+	{
+		return (uint32_t) (samples.size() / 2);
+	}
+
+
+	AudioMixer::AudioMixer(const uint8_t voices, const uint32_t max_frames_per_block) :
+		max_frames_per_block(std::max(max_frames_per_block, (uint32_t) 1)),
+		voices(voices, Voice{ nullptr, nullptr, 0, 0, 0, Repetition::ONCE, 0 }),
+		accumulator((size_t) this->max_frames_per_block * 2),
+		stream_samples((size_t) this->max_frames_per_block * 2),
+		plays_started(0)
+	{
+		if (voices == 0 || voices >= NO_VOICE)
+			throw std::runtime_error("The mixer needs some voices, but less than 255.");
+	}
+
+	AudioMixer::VoiceId AudioMixer::play(const AudioClip& clip, const float gain, const float pan, const Repetition repetition) noexcept
+	{
+		if (clip.frames() == 0)
+			return NO_VOICE;
+
+		const VoiceId chosen = choose_voice();
+		if (chosen == NO_VOICE)
+			return NO_VOICE;
+
+		voices[chosen] = Voice{ &clip, nullptr, 0, 0, 0, repetition, plays_started++ };
+		set_gain(chosen, gain, pan);
+		return chosen;
+	}
+
+	AudioMixer::VoiceId AudioMixer::play(MusicStream& stream, const float gain, const float pan) noexcept
+	{
+		const VoiceId chosen = choose_voice();
+		if (chosen == NO_VOICE)
+			return NO_VOICE;
+
+		voices[chosen] = Voice{ nullptr, &stream, 0, 0, 0, Repetition::LOOP, plays_started++ };
+		set_gain(chosen, gain, pan);
+		return chosen;
+	}
+
+	AudioMixer::VoiceId AudioMixer::choose_voice() const noexcept
+	{
+		// The first free voice. While all of them are busy, keep the oldest sound that plays once: it gets stolen.
+		VoiceId chosen = NO_VOICE;
+		for (VoiceId v = 0; v < voices.size(); ++v) {
+			const Voice& candidate = voices[v];
+			if (!candidate.busy())
+				return v;
+
+			// Ages, not start orders: the counter may have wrapped around.
+			if (candidate.repetition == Repetition::ONCE &&
+				(chosen == NO_VOICE || plays_started - candidate.start_order > plays_started - voices[chosen].start_order))
+				chosen = v;
+		}
+
+		return chosen;
+	}
+
+	/** Balance more than pan: in the center both channels are at full gain (a mono sound is as loud as it was),
+	moving to a side lowers the other one. */
+	void AudioMixer::set_gain(const VoiceId voice, const float gain, const float pan) noexcept
+	{
+		if (!playing(voice))
+			return;
+
+		const float clamped_pan = std::min(std::max(pan, -1.0f), 1.0f);
+		voices[voice].left_gain = fixed_point_gain(gain * std::min(1.0f, 1 - clamped_pan));
+		voices[voice].right_gain = fixed_point_gain(gain * std::min(1.0f, 1 + clamped_pan));
+	}
+
+	void AudioMixer::stop(const VoiceId voice) noexcept
+	{
+		if (voice < voices.size()) {
+			voices[voice].clip = nullptr;
+			voices[voice].stream = nullptr;
+		}
+	}
+
+	bool AudioMixer::playing(const VoiceId voice) const noexcept
+	{
+		return voice < voices.size() && voices[voice].busy();
+	}
+
+	uint8_t AudioMixer::voices_playing() const noexcept
+	{
+		return (uint8_t) std::count_if(voices.begin(), voices.end(), [](const Voice& v) { return v.busy(); });
+	}
+
+	void AudioMixer::mix(int16_t* stereo_samples, uint32_t frames) noexcept
+	{
+		while (frames > 0) {
+			const uint32_t block = std::min(frames, max_frames_per_block);
+			std::fill(accumulator.begin(), accumulator.begin() + (size_t) block * 2, 0);
+
+			for (Voice& voice : voices)
+				if (voice.busy())
+					accumulate(voice, block);
+
+			saturate(accumulator.data(), stereo_samples, block * 2);
+			stereo_samples += (size_t) block * 2;
+			frames -= block;
+		}
+	}
+
+	/** A stream gives its frames in one piece. The clip in pieces without a jump: from the position to its end,
+	then again from the start if it loops. */
+	void AudioMixer::accumulate(Voice& voice, const uint32_t frames) noexcept
+	{
+		const bool silent = voice.left_gain == 0 && voice.right_gain == 0;
+
+		if (voice.stream != nullptr) {
+			// Taken even when silent: the music keeps its place in time, as a clip does.
+			voice.stream->take(stream_samples.data(), frames);
+			if (!silent)
+				add_scaled(stream_samples.data(), voice.left_gain, voice.right_gain, accumulator.data(), frames * 2);
+			return;
+		}
+
+		const uint32_t clip_frames = voice.clip->frames();
+		uint32_t done = 0;
+
+		while (done < frames) {
+			const uint32_t piece = std::min(frames - done, clip_frames - voice.position);
+			if (!silent)
+				add_scaled(voice.clip->samples.data() + (size_t) voice.position * 2, voice.left_gain, voice.right_gain,
+					accumulator.data() + (size_t) done * 2, piece * 2);
+
+			voice.position += piece;
+			done += piece;
+
+			if (voice.position == clip_frames) {
+				voice.position = 0;
+				if (voice.repetition == Repetition::ONCE) {
+					voice.clip = nullptr;
+					return;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "MusicStream.h"
+
+namespace rc {
+
+	/** A sound already in the format of the device: signed 16 bits, 2 channels, interleaved (left, right, left...).
+	The interface converts the files once, when it loads them: the mixer never converts anything. */
+	struct AudioClip {
+		std::vector<int16_t> samples;
+
+		uint32_t frames() const noexcept;
+	};
+
+
+	/** Plays many clips at the same time, each on its own voice with its gain and pan.
+
+	The voices are a fixed pool. When all of them are busy a new sound takes the voice of the oldest sound that
+	plays once (voice stealing): the newest shot matters more than the tail of an old one. The looping sounds (the
+	music) are never stolen. A voice plays a clip, all in memory, or a MusicStream, read from the file while it plays.
+
+	Mixing is linear in the voices and in the frames, and it does not allocate: it can run in the audio callback.
+	Each voice is scaled and added to a 32 bits accumulator (SSE2 when there is, 8 samples at a time), the sum is
+	saturated to 16 bits only at the end: many loud sounds together clip, they do not wrap around.
+	Gains are fixed point with 14 fractional bits, a voice can be up to (almost) twice as loud as its clip.
+	*/
+	class AudioMixer {
+	public:
+		enum class Repetition : uint8_t {
+			ONCE,
+			LOOP
+		};
+
+		using VoiceId = uint8_t;
+		static constexpr VoiceId NO_VOICE = 0xFF;
+
+		/** Mixes at most max_frames_per_block at once, longer requests are done in blocks.
+		Throws if there are no voices or too many for a VoiceId. */
+		AudioMixer(const uint8_t voices, const uint32_t max_frames_per_block);
+
+		/** Starts the clip from the beginning. Gain from 0 to 2, pan from -1 (left) to 1 (right).
+		NO_VOICE if the clip is empty, or if all the voices loop. The clip must live while it plays. */
+		VoiceId play(const AudioClip& clip, const float gain, const float pan, const Repetition repetition) noexcept;
+
+		/** Plays the frames of the stream as they come: it loops like the stream does, and it is never stolen.
+		NO_VOICE if all the voices loop. Only this voice must take from the stream, which must live while it plays. */
+		VoiceId play(MusicStream& stream, const float gain, const float pan) noexcept;
+
+		/** Changes a playing voice. A voice with gain 0 costs nothing to mix, but it keeps its place in the clip
+		(a stream still gives away its frames). */
+		void set_gain(const VoiceId voice, const float gain, const float pan) noexcept;
+
+		void stop(const VoiceId voice) noexcept;
+		bool playing(const VoiceId voice) const noexcept;
+		uint8_t voices_playing() const noexcept;
+
+		/** Fills the frames (2 samples each) with the sum of all the voices, and moves them forward. */
+		void mix(int16_t* stereo_samples, uint32_t frames) noexcept;
+
+		const uint32_t max_frames_per_block;
+
+	private:
+		struct Voice {
+			const AudioClip* clip;  /// Both nullptr when the voice is free.
+			MusicStream* stream;
+			uint32_t position;  /// Next frame to play.
+			int16_t left_gain;
+			int16_t right_gain;
+			Repetition repetition;
+			uint32_t start_order;  /// To find the oldest.
+
+			bool busy() const noexcept { return clip != nullptr || stream != nullptr; }
+		};
+
+		std::vector<Voice> voices;
+		std::vector<int32_t> accumulator;
+		std::vector<int16_t> stream_samples;  /// A block taken from a stream, before it is scaled.
+		uint32_t plays_started;
+
+		/** A free voice, or the one to steal. */
+		VoiceId choose_voice() const noexcept;
+		void accumulate(Voice& voice, const uint32_t frames) noexcept;
+	};
+}
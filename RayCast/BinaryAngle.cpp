@@ -0,0 +1,131 @@
+#include "pch.h"
+#include "BinaryAngle.h"
+
+#include <cmath>
+#include <vector>
+
+namespace rc {
+
+	const float BinaryAngle::RESOLUTION_RADIANS = (float) (BinaryAngle::FULL_TURN_RADIANS / BinaryAngle::FULL_TURN);
+
+	/** One entry for each possible angle. Built by the first call (thread safe, it is a function static). */
+	struct TrigTables {
+		std::vector<float> sine;
+		std::vector<float> tangent;
+		std::vector<float> secant;
+
+		TrigTables() :
+			sine(BinaryAngle::FULL_TURN),
+			tangent(BinaryAngle::FULL_TURN),
+			secant(BinaryAngle::FULL_TURN)
+		{
+			// The sine of the first quarter, mirrored on the others: the table is exactly symmetric and
+			// sin(PI) is exactly 0 (no "almost 0" like with the float PI).
+			for (uint32_t units = 0; units <= BinaryAngle::QUARTER_TURN; ++units) {
+				const float value = (float) std::sin(units * BinaryAngle::FULL_TURN_RADIANS / BinaryAngle::FULL_TURN);
+				sine[units] = value;
+				sine[BinaryAngle::HALF_TURN - units] = value;
+				sine[BinaryAngle::HALF_TURN + units] = -value;
+				sine[(BinaryAngle::FULL_TURN - units) % BinaryAngle::FULL_TURN] = -value;
+			}
+
+			for (uint32_t units = 0; units < BinaryAngle::FULL_TURN; ++units) {
+				// At exactly PI / 2 the double cosine is not 0, but tiny: the results are huge and finite, as wanted.
+				const double radians = units * BinaryAngle::FULL_TURN_RADIANS / BinaryAngle::FULL_TURN;
+				tangent[units] = (float) std::tan(radians);
+				secant[units] = (float) (1 / std::cos(radians));
+			}
+		}
+	};
+
+	static const TrigTables& tables() {
+		static const TrigTables trig_tables;
+		return trig_tables;
+	}
+
+
+	BinaryAngle::BinaryAngle() noexcept :
+		units(0)
+	{
+	}
+
+	BinaryAngle::BinaryAngle(const float radians) noexcept :
+		units(units_from_radians(radians))
+	{
+	}
+
+	BinaryAngle BinaryAngle::from_units(const uint16_t units) noexcept
+	{
+		BinaryAngle angle;
+		angle.units = units;
+		return angle;
+	}
+
+	float BinaryAngle::radians() const noexcept
+	{
+		return (float) (units * FULL_TURN_RADIANS / FULL_TURN);
+	}
+
+	float BinaryAngle::sin() const noexcept
+	{
+		return tables().sine[units];
+	}
+
+	float BinaryAngle::cos() const noexcept
+	{
+		return tables().sine[(uint16_t) (units + QUARTER_TURN)];
+	}
+
+	float BinaryAngle::tan() const noexcept
+	{
+		return tables().tangent[units];
+	}
+
+	float BinaryAngle::sec() const noexcept
+	{
+		return tables().secant[units];
+	}
+
+	bool BinaryAngle::facing_up() const noexcept
+	{
+		return units < HALF_TURN;
+	}
+
+	bool BinaryAngle::facing_right() const noexcept
+	{
+		// Turned by a quarter, the right half lands on the upper half.
+		return (uint16_t) (units + QUARTER_TURN) < HALF_TURN;
+	}
+
+	BinaryAngle& BinaryAngle::operator+=(const BinaryAngle& other) noexcept
+	{
+		units += other.units;
+		return *this;
+	}
+
+	BinaryAngle& BinaryAngle::operator-=(const BinaryAngle& other) noexcept
+	{
+		units -= other.units;
+		return *this;
+	}
+
+	BinaryAngle operator+(BinaryAngle lhs, const BinaryAngle& rhs) noexcept
+	{
+		return lhs += rhs;
+	}
+
+	BinaryAngle operator-(BinaryAngle lhs, const BinaryAngle& rhs) noexcept
+	{
+		return lhs -= rhs;
+	}
+
+	bool operator==(const BinaryAngle& lhs, const BinaryAngle& rhs) noexcept
+	{
+		return lhs.units == rhs.units;
+	}
+
+	bool operator!=(const BinaryAngle& lhs, const BinaryAngle& rhs) noexcept
+	{
+		return !(lhs == rhs);
+	}
+}
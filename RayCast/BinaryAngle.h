@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+
+namespace rc {
+
+	/** An angle in "binary angle measurement": a fraction of the full turn, in 16 bits.
+	0 is "toward +X", 0x4000 is a quarter of turn (PI / 2), 0x8000 half a turn...
+
+	The wraparound of the unsigned integer is the wraparound of the angle: the sum of two angles is always
+	between 0 and 2 PI, for free. No more normalization loops, clamps and range checks, and no rounding error
+	piling up while the player turns. The quadrant is in the 2 highest bits.
+
+	The step is 2 PI / 65536, about 0.0055 degrees: the columns of the projection plane are some 0.1 degrees apart.
+
+	The trigonometry comes from tables with an entry for each of the 65536 angles, computed once, on the first use.
+	No interpolation: the angle can not fall between two entries. Each table is 256 KB. Only the sine table is
+	shared (the cosine is the sine a quarter of turn later).
+
+	It converts from radians without complaining (any value, even negative or beyond 2 PI), so the code that
+	is happy with floats can keep them.
+	*/
+	class BinaryAngle {
+	public:
+		/** 0, toward +X. */
+		BinaryAngle() noexcept;
+
+		/** Rounded to the closest step and wrapped. Not explicit on purpose: radians are welcome everywhere. */
+		BinaryAngle(const float radians) noexcept;
+
+		/** The conversion of the constructor, usable at compile time (see FixedProjectionPlane).
+		Rounds half away from zero, like std::llround. The cast to unsigned wraps the negative values
+		and the values beyond the full turn (modulo 2^16). */
+		static constexpr uint16_t units_from_radians(const float radians) noexcept {
+			const double steps = radians / FULL_TURN_RADIANS * FULL_TURN;
+			return (uint16_t) (steps >= 0 ? (int64_t) (steps + 0.5) : -(int64_t) (-steps + 0.5));
+		}
+
+		static BinaryAngle from_units(const uint16_t units) noexcept;
+
+		float radians() const noexcept;
+
+		float sin() const noexcept;
+		float cos() const noexcept;
+		float tan() const noexcept;
+		/** 1 / cos. */
+		float sec() const noexcept;
+
+		/** Between 0 and PI: the Z grows along a ray with this direction. */
+		bool facing_up() const noexcept;
+		/** Between -PI / 2 and PI / 2: the X grows along a ray with this direction. */
+		bool facing_right() const noexcept;
+
+		BinaryAngle& operator+=(const BinaryAngle& other) noexcept;
+		BinaryAngle& operator-=(const BinaryAngle& other) noexcept;
+
+		/** Steps of 2 PI / FULL_TURN. */
+		uint16_t units;
+
+		static constexpr uint32_t FULL_TURN = 65536;
+		static constexpr uint16_t QUARTER_TURN = FULL_TURN / 4;
+		static constexpr uint16_t HALF_TURN = FULL_TURN / 2;
+
+		/** In double: PI.h only has a float PI. */
+		static constexpr double FULL_TURN_RADIANS = 6.283185307179586476925286766559;
+
+		/** The size of a step, in radians. The error of a conversion is at most half of it. */
+		static const float RESOLUTION_RADIANS;
+	};
+
+	BinaryAngle operator+(BinaryAngle lhs, const BinaryAngle& rhs) noexcept;
+	BinaryAngle operator-(BinaryAngle lhs, const BinaryAngle& rhs) noexcept;
+	bool operator==(const BinaryAngle& lhs, const BinaryAngle& rhs) noexcept;
+	bool operator!=(const BinaryAngle& lhs, const BinaryAngle& rhs) noexcept;  // Remove with C++20.
+}
@@ -0,0 +1,20 @@
+#include "pch.h"
+#include "Camera.h"
+
+#include <cmath>
+
+namespace rc {
+
+	Camera interpolate(const Camera& from, const Camera& to, const float fraction) noexcept
+	{
+		// As a signed number, the difference of the units is the shortest turn from one angle to the other.
+		const int16_t turn = (int16_t) (to.orientation - from.orientation).units;
+		const int16_t partial_turn = (int16_t) std::lround(turn * fraction);
+
+		return Camera{
+			from.x + (to.x - from.x) * fraction,
+			from.z + (to.z - from.z) * fraction,
+			from.orientation + BinaryAngle::from_units((uint16_t) partial_turn)
+		};
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "BinaryAngle.h"
+
+namespace rc {
+
+	/** Where a view of the world is seen from: a position on the floor plane and a direction.
+
+	The player has one (see Player::camera), but it is not the only one. A rear-view mirror looks from the
+	player position in the opposite direction, a split screen has a camera for each player.
+	*/
+	struct Camera {
+		float x;
+		float z;
+		BinaryAngle orientation;
+	};
+
+	inline bool operator==(const Camera& c1, const Camera& c2) noexcept {
+		return c1.x == c2.x && c1.z == c2.z && c1.orientation == c2.orientation;
+	}
+
+	inline bool operator!=(const Camera& c1, const Camera& c2) noexcept {
+		return !(c1 == c2);
+	}
+
+	/** The camera at a fraction (0 to 1) of the way from one to the other, for the frames that fall between two
+	steps of the simulation (see FixedTimestep). The orientation turns the short way around. */
+	Camera interpolate(const Camera& from, const Camera& to, const float fraction) noexcept;
+}
@@ -0,0 +1,50 @@
+#include "pch.h"
+#include "Canvas.h"
+
+#include <algorithm>
+
+namespace rc {
+
+	/** The ends are returned exactly, the interpolation would round them. */
+	float WallSpan::height_at(const uint16_t column) const noexcept
+	{
+		if (column == first_column)
+			return first_height;
+		if (column == last_column)
+			return last_height;
+
+		const float t = (float) (column - first_column) / (last_column - first_column);
+		return (1 - t) * first_height + t * last_height;
+	}
+
+	float WallSpan::offset_at(const uint16_t column) const noexcept
+	{
+		if (column == first_column)
+			return first_offset;
+		if (column == last_column)
+			return last_offset;
+
+		const float t = (float) (column - first_column) / (last_column - first_column);
+		const float height = (1 - t) * first_height + t * last_height;
+		const float offset_by_height = (1 - t) * first_offset * first_height + t * last_offset * last_height;
+		return offset_by_height / height;
+	}
+
+	SliceProjection WallSpan::slice_at(const uint16_t column, const uint16_t rows) const noexcept
+	{
+		const int32_t full_height = (int32_t) height_at(column);
+		const int32_t full_top_row = rows / 2 - full_height / 2;
+
+		const int32_t visible_top_row = std::max(full_top_row, 0);
+		const int32_t visible_bottom_row = std::min(full_top_row + full_height, (int32_t) rows);
+
+		SliceProjection slice;
+		slice.top_row = (uint16_t) std::min(visible_top_row, (int32_t) rows);
+		slice.height = (uint16_t) std::max(visible_bottom_row - visible_top_row, 0);
+		slice.texture_step = (float) object_size / std::max(full_height, 1);
+		slice.texture_top = (visible_top_row - full_top_row) * slice.texture_step;
+		slice.light_level = light_level;
+
+		return slice;
+	}
+}
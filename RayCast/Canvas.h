@@ -12,14 +12,71 @@ namespace rc {
 		ENEMY = 0b00000010,
 		FONT =  0b00000100,
 		HUD =   0b00001000,
-		EXIT =  0b00010000
+		EXIT =  0b00010000,
+		FLOOR = 0b00100000,
+		CEILING = 0b01000000
 	};
 
 
+	/** Results of projecting a piece of some object, already clipped to the screen.
+
+	The texture coordinates tell which part of the texture column goes in the visible rows.
+	The texture is assumed to be as tall as the projected object is in world units.
+	*/
+	struct SliceProjection {
+		uint16_t top_row;  /// Never negative, the rows above the screen are clipped away.
+		uint16_t height;  /// Only the visible rows. May be 0 if nothing is visible.
+		float texture_top;  /// Texture row (it can fall between 2 texels) drawn on the top row.
+		float texture_step;  /// Texture rows for each row on the screen.
+		uint8_t light_level;  /// From the distance, see Shading.h. 0 is full light.
+	};
+
+
+	/** Projection of a flat piece of wall that covers several consecutive columns.
+
+	The slices are centered on the horizon (half the rows). Only the first and the last are given: in between,
+	the height (that goes like 1 / distance) and the texture offset multiplied by the height change linearly
+	with the column (perspective correct interpolation, like a textured quad on the GPU). ProjectionPlane only merges columns
+	where this gives the same slices of the ray casting, within half a pixel and half a texel.
+	*/
+	struct WallSpan {
+		uint16_t first_column;
+		uint16_t last_column;  /// Included.
+		float first_height;  /// Not clipped: may be taller than the screen.
+		float last_height;
+		float first_offset;  /// Texture column at the first column, with the fraction.
+		float last_offset;
+		uint16_t object_size;  /// Height of the wall in world units (texture rows).
+		uint8_t light_level;  /// The same for all the columns.
+
+		float height_at(const uint16_t column) const noexcept;
+		float offset_at(const uint16_t column) const noexcept;
+
+		/** The same slice that ProjectionPlane::project_slice gives for the column, with a screen of the given rows. */
+		SliceProjection slice_at(const uint16_t column, const uint16_t rows) const noexcept;
+	};
+
+
+	/** Where the char is in the font bitmap (8x8 cells of 8x8 pixels, counting row by row), or -1 if there is
+	no such letter. Numbers 0 to 9, then some space and the uppercase letters, then ! and : and then... stop. */
+	inline int8_t font_glyph(const char c) noexcept
+	{
+		if ('A' <= c && c <= 'Z')
+			return c - 'A' + 18;  // Letters starts after digits and some spave and 'A' is the 1st letter in the bitmap.
+		if ('0' <= c && c <= ':')  // The ':' is just after '9' in ASCII.
+			return c - '0';
+		if (c == '!')
+			return 44;  // I know where this is on the bitmap...
+		return -1;
+	}
+
+
 	/** Interface that hides the real graphics API and allows to replace it with a mock. 
 	
 	Not worried about the indirection performance cost. Testing is more important.
-	If profiling shows this is a bottleneck, sub-classing can be replaced by templates.
+	Where it did matter (a virtual call for every column, at high resolution) the sub-classing was replaced by
+	templates: ProjectionPlane::project_objects takes the real type of the canvas. This interface stays for
+	everything else, and as the adapter for the code that only has a Canvas.
 	*/
 	class Canvas {
 	public:
@@ -31,19 +88,19 @@ namespace rc {
 		The strip starts at the top_row and goes down for all its height. The content is whatever is in the
 		1-pixel-wide column of the wall texture at the given offset.
 
-		In other words: take a column of pixels from the texture and copy it in the column of the screen between the 
-		top row and the top row+height (scale it if necessary).
+		In other words: take a column of pixels from the texture, starting at the texture_top row and moving
+		by texture_step for each screen pixel, and copy it in the column of the screen between the 
+		top row and the top row+height. The pixels are darkened to the light level of the slice.
 
-		Notice that the top row may be negative, the slice may start outside the screen when the player is very close
-		to a the object.
-		*/
-		virtual void draw_slice(const uint16_t column, const int16_t top_row, const uint16_t height, const uint16_t texture_offset, const TextureIndex what_to_draw) = 0;
-	
-		/** Returns true if the given pixel of the matching image has a low alpha (less than 128, half-way in the scale).
-		* 
-		*  Such pixels are invisible to the user and should not be taken into account for collision detection, shooting...
+		The slice is always inside the screen. When the player is very close to an object, the projection
+		clips away what is outside, so that the frame does not cost more than any other.
 		*/
-		virtual bool transparent_pixel(const uint8_t x, const uint8_t y, const TextureIndex image) const = 0;
+		virtual void draw_slice(const uint16_t column, const SliceProjection& slice, const uint16_t texture_offset, const TextureIndex what_to_draw) = 0;
+
+		/** Many slices of the same face of a wall at once. The result should be the same as calling draw_slice
+		for each column with span.slice_at(column), but there is only a call instead of tens. The implementation
+		can draw it as a textured quad or as a loop. */
+		virtual void draw_span(const WallSpan& span, const TextureIndex what_to_draw) = 0;
 	
 		/** Print the text string starting at the (row, column) pixel. The letters should be square, are assumed to 
 		be 8x8 pixels in a bitmap (refer to the file itself to see where the letters go). Scales the letters so that
@@ -0,0 +1,48 @@
+#include "pch.h"
+#include "ColumnCoverage.h"
+
+#include <algorithm>
+
+namespace rc {
+
+	ColumnCoverage::ColumnCoverage(const uint16_t columns, const uint16_t rows) :
+		rows(rows),
+		covered(columns)
+	{
+	}
+
+	void ColumnCoverage::clear() noexcept
+	{
+		for (std::vector<RowSpan>& spans : covered)
+			spans.clear();
+	}
+
+	bool ColumnCoverage::full(const uint16_t column) const noexcept
+	{
+		const std::vector<RowSpan>& spans = covered[column];
+		return spans.size() == 1 && spans.front().top == 0 && spans.front().bottom >= rows;
+	}
+
+	void ColumnCoverage::cover(const uint16_t column, const uint16_t top, const uint16_t bottom)
+	{
+		if (top >= bottom)
+			return;
+
+		std::vector<RowSpan>& spans = covered[column];
+
+		// The first span that touches the new one or is below it.
+		auto first_merged = std::find_if(spans.begin(), spans.end(),
+			[top](const RowSpan& span) { return span.bottom >= top; });
+
+		RowSpan merged{ top, bottom };
+		auto after_merged = first_merged;
+		while (after_merged != spans.end() && after_merged->top <= bottom) {
+			merged.top = std::min(merged.top, after_merged->top);
+			merged.bottom = std::max(merged.bottom, after_merged->bottom);
+			++after_merged;
+		}
+
+		const auto position = spans.erase(first_merged, after_merged);
+		spans.insert(position, merged);
+	}
+}
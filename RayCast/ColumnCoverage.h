@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rc {
+
+	/** Remembers which rows of each screen column have already been painted by an opaque object.
+
+	Used to draw the sprites front to back: the closest sprite goes first, the farther ones only fill the rows
+	that are still free. Each pixel is then written at most once, no matter how many sprites are stacked behind
+	each other (the painter's algorithm draws all of them and lets the last one win).
+
+	Every column keeps a short list of covered row intervals, sorted and never overlapping or touching.
+	There are few sprites in the same column, so the lists stay small and a vector is faster than anything smart.
+	*/
+	class ColumnCoverage {
+	public:
+		/** Rows from top up to bottom (excluded). */
+		struct RowSpan {
+			uint16_t top;
+			uint16_t bottom;
+		};
+
+		ColumnCoverage(const uint16_t columns, const uint16_t rows);
+
+		/** Nothing covered, as at the beginning of a frame. Keeps the memory. */
+		void clear() noexcept;
+
+		/** True when nothing more can be drawn in the column. */
+		bool full(const uint16_t column) const noexcept;
+
+		/** Calls free_span(RowSpan) for each part of [top, bottom) that is not covered yet, top to bottom. */
+		template <typename FREE_SPAN>
+		void for_each_free_span(const uint16_t column, const uint16_t top, const uint16_t bottom, FREE_SPAN free_span) const;
+
+		/** Marks the rows as covered, merging with the other covered spans. */
+		void cover(const uint16_t column, const uint16_t top, const uint16_t bottom);
+
+		const uint16_t rows;
+
+	private:
+		std::vector<std::vector<RowSpan>> covered;
+	};
+
+
+	template <typename FREE_SPAN>
+	void ColumnCoverage::for_each_free_span(const uint16_t column, const uint16_t top, const uint16_t bottom, FREE_SPAN free_span) const
+	{
+		uint16_t row = top;
+
+		for (const RowSpan& span : covered[column]) {
+			if (span.bottom <= row)
+				continue;
+			if (span.top >= bottom)
+				break;
+
+			if (span.top > row)
+				free_span(RowSpan{ row, span.top });
+
+			row = span.bottom;
+			if (row >= bottom)
+				return;
+		}
+
+		if (row < bottom)
+			free_span(RowSpan{ row, bottom });
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "BinaryAngle.h"
+#include "PI.h"
+#include "ProjectionPlane.h"
+
+namespace rc {
+
+	/** Trigonometry usable at compile time: std::sin and friends are not constexpr (not before C++26).
+	Taylor series in double, good to the last bit of a float for angles within a quarter of turn
+	(more than any field of view needs). */
+	namespace compile_time {
+
+		constexpr double sin(const double radians) noexcept {
+			double term = radians;
+			double sum = radians;
+			for (int n = 1; n < 15; ++n) {
+				term *= -radians * radians / ((2 * n) * (2 * n + 1));
+				sum += term;
+			}
+			return sum;
+		}
+
+		constexpr double cos(const double radians) noexcept {
+			double term = 1;
+			double sum = 1;
+			for (int n = 1; n < 15; ++n) {
+				term *= -radians * radians / ((2 * n - 1) * (2 * n));
+				sum += term;
+			}
+			return sum;
+		}
+
+		constexpr double tan(const double radians) noexcept {
+			return sin(radians) / cos(radians);
+		}
+	}
+
+
+	/** A ProjectionPlane whose resolution and field of view are known at compile time, e. g. for the
+	kiosks that always run at 640x480 with a 60 degrees FOV.
+
+	The tables (column angles, fishbowl correction), the distance to the point of view and the centers are
+	computed by the compiler, with the same float operations of the runtime plane: the picture is the same.
+	The fishbowl pass and the wall pass run on loops with a fixed trip count, COLUMNS. The fishbowl one reads the
+	constexpr table, the compiler can unroll and vectorize it. The rays and the sprites are the usual
+	ProjectionPlane, so it can be used wherever one is expected: that is why the base class still gets a copy of
+	the COLUMN_ANGLES, for the rays and for the FloorCaster.
+
+	The FOV is an integer number of degrees: floats are not allowed as template parameters.
+	*/
+	template <uint16_t H_RESOLUTION, uint16_t V_RESOLUTION, uint8_t FOV_DEGREES>
+	class FixedProjectionPlane : public ProjectionPlane
+	{
+		static_assert(H_RESOLUTION > 0 && V_RESOLUTION > 0, "The plane needs some pixels.");
+		static_assert(FOV_DEGREES > 0 && FOV_DEGREES < 180, "The field of view must be less than half a turn.");
+
+	public:
+		static constexpr uint16_t COLUMNS = H_RESOLUTION;
+		static constexpr uint16_t ROWS = V_RESOLUTION;
+		static constexpr uint16_t X_CENTER = H_RESOLUTION / 2;
+		static constexpr uint16_t Y_CENTER = V_RESOLUTION / 2;
+
+		/** Like ProjectionPlane::to_radians(FOV / columns), in float. */
+		static constexpr float SCAN_STEP_RADIANS = (float) FOV_DEGREES / H_RESOLUTION * PI / 180;
+
+		/** Like ProjectionPlane::pov_distance. The tangent is in double, then rounded like the float one. */
+		static constexpr uint32_t DISTANCE_TO_POV =
+			(uint32_t) (float) ((H_RESOLUTION / 2.0f) / (float) compile_time::tan((float) FOV_DEGREES * PI / 180 / 2));
+
+		static constexpr std::array<float, H_RESOLUTION> COLUMN_ANGLES = [] {
+			std::array<float, H_RESOLUTION> angles{};
+			for (uint16_t column = 0; column < H_RESOLUTION; ++column)
+				angles[column] = ((int32_t) column - H_RESOLUTION / 2) * SCAN_STEP_RADIANS;
+			return angles;
+		}();
+
+		/** The cosine of the binary angle of each column: the same value of its BinaryAngle::cos(). */
+		static constexpr std::array<float, H_RESOLUTION> FISHBOWL = [] {
+			std::array<float, H_RESOLUTION> factors{};
+			for (uint16_t column = 0; column < H_RESOLUTION; ++column) {
+				// The table of BinaryAngle mirrors the sine of the first quarter: do the same.
+				const int16_t units = (int16_t) BinaryAngle::units_from_radians(COLUMN_ANGLES[column]);
+				const int32_t from_quarter = BinaryAngle::QUARTER_TURN - (units < 0 ? -units : units);
+				factors[column] = (float) compile_time::sin(from_quarter * BinaryAngle::FULL_TURN_RADIANS / BinaryAngle::FULL_TURN);
+			}
+			return factors;
+		}();
+
+		FixedProjectionPlane() :
+			ProjectionPlane(H_RESOLUTION, V_RESOLUTION, DISTANCE_TO_POV, SCAN_STEP_RADIANS,
+				std::vector<float>(COLUMN_ANGLES.begin(), COLUMN_ANGLES.end()))
+		{
+		}
+
+	protected:
+		void correct_fishbowl() override {
+			for (uint16_t scan_column = 0; scan_column < COLUMNS; ++scan_column) {
+				const RayHit& wall_hit = wall_hits[scan_column];
+				depth_buffer[scan_column] = wall_hit.really_hit() ?
+					wall_hit.distance * FISHBOWL[scan_column] :
+					std::numeric_limits<float>::max();
+			}
+		}
+
+		void project_walls(const Grid& grid) override {
+			for (uint16_t scan_column = 0; scan_column < COLUMNS; ++scan_column)
+				project_wall_column(grid, scan_column);
+		}
+	};
+}
@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "FixedTimestep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace rc {
+
+	FixedTimestep::FixedTimestep(const float step_seconds, const uint8_t max_steps_per_frame) :
+		step_seconds(step_seconds),
+		max_steps_per_frame(max_steps_per_frame),
+		accumulated_seconds(0)
+	{
+		if (!(step_seconds > 0))
+			throw std::runtime_error("The simulation step must last some time.");
+		if (max_steps_per_frame == 0)
+			throw std::runtime_error("The simulation must be allowed at least a step per frame.");
+	}
+
+	uint8_t FixedTimestep::steps_for(const float elapsed_seconds) noexcept
+	{
+		accumulated_seconds += std::max(elapsed_seconds, 0.0f);
+
+		const float due_steps = std::floor(accumulated_seconds / step_seconds);
+		if (due_steps > max_steps_per_frame) {
+			// Too far behind: drop the whole steps that do not fit, keep the fraction for the interpolation.
+			accumulated_seconds = std::fmod(accumulated_seconds, step_seconds);
+			return max_steps_per_frame;
+		}
+
+		accumulated_seconds -= due_steps * step_seconds;
+		return (uint8_t) due_steps;
+	}
+
+	float FixedTimestep::interpolation() const noexcept
+	{
+		// The subtraction can leave a hair too much or too little.
+		return std::min(std::max(accumulated_seconds / step_seconds, 0.0f), std::nextafter(1.0f, 0.0f));
+	}
+
+	void FixedTimestep::reset() noexcept
+	{
+		accumulated_seconds = 0;
+	}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+namespace rc {
+
+	/** Runs the simulation at a fixed rate, whatever the frame rate of the rendering.
+
+	After every frame the caller tells how much real time went by. The time piles up, and the simulation
+	runs as many steps of step_seconds as fit in it: none on a fast frame, a few on a slow one. The
+	game moves at the same speed on any machine, and a step always has the same length, so the same input
+	always gives the same movement.
+
+	What is left, less than a step, tells where the frame falls between the last two states of the
+	simulation. The renderer interpolates between them (see interpolate in Camera.h): the movement looks
+	smooth even when the frames and the steps do not line up.
+
+	A very long frame (the window was dragged, a breakpoint...) would need many steps at once, that take time,
+	that make the next frame longer... There is a limit to the steps of a frame, the time beyond it is lost:
+	the game slows down instead.
+	*/
+	class FixedTimestep {
+	public:
+		/** Throws if the step is not positive or if there can be no steps at all. */
+		FixedTimestep(const float step_seconds, const uint8_t max_steps_per_frame);
+
+		/** Adds the real time of the last frame, tells how many steps the simulation must run now. */
+		uint8_t steps_for(const float elapsed_seconds) noexcept;
+
+		/** The time piled up and not simulated yet, as a fraction of a step: from 0 (included) to 1. */
+		float interpolation() const noexcept;
+
+		/** Forgets the time not simulated yet. */
+		void reset() noexcept;
+
+		const float step_seconds;
+		const uint8_t max_steps_per_frame;
+
+	private:
+		float accumulated_seconds;
+	};
+}
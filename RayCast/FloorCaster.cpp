@@ -0,0 +1,127 @@
+#include "pch.h"
+#include "FloorCaster.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+// SSE2 is always there on x64, it must be enabled on 32 bits.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RC_FLOOR_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace rc {
+
+	static void check_surface(const ShadedTexture& texture) {
+		const bool power_of_2 = texture.width != 0 && (texture.width & (texture.width - 1)) == 0;
+		if (texture.width != texture.height || !power_of_2)
+			throw std::runtime_error("Floor and ceiling textures must be square, with a power of 2 side.");
+	}
+
+	static uint8_t log2_of(uint16_t power_of_2) {
+		uint8_t exponent = 0;
+		while (power_of_2 > 1) {
+			power_of_2 >>= 1;
+			++exponent;
+		}
+		return exponent;
+	}
+
+	FloorCaster::FloorCaster(const ProjectionPlane& plane, const uint8_t cell_size, ShadedTexture floor, ShadedTexture ceiling) :
+		columns(plane.columns),
+		rows(plane.rows),
+		horizon_row(plane.y_center),
+		distance_to_POV(plane.distance_to_POV),
+		cell_size(cell_size),
+		eye_height(cell_size / 2.0f),
+		column_tangents(plane.columns),
+		floor(std::move(floor)),
+		ceiling(std::move(ceiling))
+	{
+		check_surface(this->floor);
+		check_surface(this->ceiling);
+
+		for (uint16_t column = 0; column < columns; ++column)
+			column_tangents[column] = std::tan(plane.column_angles[column]);
+	}
+
+	void FloorCaster::cast(const Camera& camera, uint32_t* frame, const uint16_t pitch) const
+	{
+		const float cos_orientation = camera.orientation.cos();
+		const float sin_orientation = camera.orientation.sin();
+
+		for (uint16_t row = 0; row < rows; ++row) {
+			// Measure from the center of the pixel, the row on the horizon would be infinitely far otherwise.
+			const float pixel_center = row + 0.5f;
+			const bool below_horizon = row >= horizon_row;
+			const float rows_from_horizon = below_horizon ? pixel_center - horizon_row : horizon_row - pixel_center;
+			const float row_distance = eye_height * distance_to_POV / rows_from_horizon;
+
+			cast_row(below_horizon ? floor : ceiling, row_distance, camera, cos_orientation, sin_orientation, frame + (size_t) row * pitch);
+		}
+	}
+
+	void FloorCaster::cast_row(const ShadedTexture& surface, const float row_distance, const Camera& camera,
+		const float cos_orientation, const float sin_orientation, uint32_t* row_pixels) const
+	{
+		// Same choice of mipmap and light of a wall slice at this distance.
+		const float projected_cell = std::min(cell_size * distance_to_POV / row_distance, 65535.0f);
+		const uint8_t mip = mip_level(surface.width, (uint16_t) projected_cell, surface.mip_levels);
+		const Texture& texture = surface.variant(light_level(row_distance), mip);
+
+		// Texel coordinates in 24.8 fixed point: base + per_tangent * tan(column angle).
+		// The texture repeats every cell: the integer part wraps with the mask.
+		constexpr float fixed_point_one = 256;
+		constexpr uint8_t fraction_bits = 8;
+		const float texels_per_unit = (float) texture.width / cell_size * fixed_point_one;
+
+		const float u_base = (camera.x + row_distance * cos_orientation) * texels_per_unit;
+		const float u_per_tangent = -row_distance * sin_orientation * texels_per_unit;
+		const float v_base = (camera.z + row_distance * sin_orientation) * texels_per_unit;
+		const float v_per_tangent = row_distance * cos_orientation * texels_per_unit;
+
+		const int32_t wrap_mask = texture.width - 1;
+		const uint8_t row_shift = log2_of(texture.width);
+		const uint32_t* texels = texture.pixels.data();
+
+		uint16_t column = 0;
+
+#ifdef RC_FLOOR_SSE2
+		const __m128 u_base_4 = _mm_set1_ps(u_base);
+		const __m128 u_per_tangent_4 = _mm_set1_ps(u_per_tangent);
+		const __m128 v_base_4 = _mm_set1_ps(v_base);
+		const __m128 v_per_tangent_4 = _mm_set1_ps(v_per_tangent);
+		const __m128i wrap_mask_4 = _mm_set1_epi32(wrap_mask);
+		const __m128i row_shift_4 = _mm_cvtsi32_si128(row_shift);
+
+		alignas(16) int32_t texel_indices[4];
+
+		for (; column + 4 <= columns; column += 4) {
+			const __m128 tangents = _mm_loadu_ps(column_tangents.data() + column);
+
+			const __m128i u = _mm_srai_epi32(_mm_cvttps_epi32(_mm_add_ps(u_base_4, _mm_mul_ps(u_per_tangent_4, tangents))), fraction_bits);
+			const __m128i v = _mm_srai_epi32(_mm_cvttps_epi32(_mm_add_ps(v_base_4, _mm_mul_ps(v_per_tangent_4, tangents))), fraction_bits);
+
+			const __m128i texel_row = _mm_sll_epi32(_mm_and_si128(v, wrap_mask_4), row_shift_4);
+			_mm_store_si128((__m128i*) texel_indices, _mm_or_si128(texel_row, _mm_and_si128(u, wrap_mask_4)));
+
+			// No gather in SSE2.
+			row_pixels[column] = texels[texel_indices[0]];
+			row_pixels[column + 1] = texels[texel_indices[1]];
+			row_pixels[column + 2] = texels[texel_indices[2]];
+			row_pixels[column + 3] = texels[texel_indices[3]];
+		}
+#endif
+
+		// Whatever the vector loop left, or everything without SSE2. Same operations, same results.
+		for (; column < columns; ++column) {
+			const float tangent = column_tangents[column];
+			const int32_t u = (int32_t) (u_base + u_per_tangent * tangent) >> fraction_bits;
+			const int32_t v = (int32_t) (v_base + v_per_tangent * tangent) >> fraction_bits;
+
+			row_pixels[column] = texels[((v & wrap_mask) << row_shift) | (u & wrap_mask)];
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Camera.h"
+#include "ProjectionPlane.h"
+#include "Shading.h"
+
+namespace rc {
+
+	/** Draws the textured floor and ceiling, one screen row at a time.
+
+	The eye is at half the height of the walls (that is why the walls are centered on the horizon).
+	All the floor pixels on the same row below the horizon are at the same distance from the camera, measured
+	along the view direction: eye height * distance_to_POV / rows below the horizon. The same for the ceiling
+	above. This distance is computed once per row, together with its light level and mipmap.
+
+	Across the row, the floor point seen by a column is at distance * (view direction + tan(column angle) * side).
+	The columns are spaced by angle and not on a flat plane (see ProjectionPlane::column_angles), therefore
+	the tangents are read from a table, not stepped by a constant. The texture coordinates are then computed
+	in fixed point, 4 columns at a time with SSE2 when available. The textures repeat once per grid cell.
+
+	The whole frame is overwritten: walls and sprites are drawn on top of it afterwards.
+	*/
+	class FloorCaster {
+	public:
+		/** The textures must be square, with a power of 2 side (the coordinates wrap with a bit mask). */
+		FloorCaster(const ProjectionPlane& plane, const uint8_t cell_size, ShadedTexture floor, ShadedTexture ceiling);
+
+		/** Fills the frame: rows * columns ARGB pixels, each row pitch pixels after the previous. */
+		void cast(const Camera& camera, uint32_t* frame, const uint16_t pitch) const;
+
+		const uint16_t columns;
+		const uint16_t rows;
+
+	private:
+		const uint16_t horizon_row;
+		const uint32_t distance_to_POV;
+		const uint8_t cell_size;
+		const float eye_height;
+
+		/** tan(column angle) for each column. */
+		std::vector<float> column_tangents;
+
+		ShadedTexture floor;
+		ShadedTexture ceiling;
+
+		void cast_row(const ShadedTexture& surface, const float row_distance, const Camera& camera,
+			const float cos_orientation, const float sin_orientation, uint32_t* row_pixels) const;
+	};
+}
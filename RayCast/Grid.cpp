@@ -94,12 +94,12 @@ bool Grid::close_to_walls(const float x, const float z, const float minimum_dist
 		;
 }
 
-RayHit Grid::cast_ray(const Ray& r) const
+RayHit Grid::cast_ray(const Ray& r, const float max_distance) const
 {
-	const float tangent = std::abs(std::tan(r.alpha_rad));
+	const float tangent = std::abs(r.alpha.tan());
 
-	RayHit horizontal_hit = cast_ray_horizontal(r, tangent);
-	RayHit vertical_hit = cast_ray_vertical(r, tangent);
+	RayHit horizontal_hit = cast_ray_horizontal(r, tangent, UNKNOWN, max_distance);
+	RayHit vertical_hit = cast_ray_vertical(r, tangent, UNKNOWN, max_distance);
 
 	// Texture mapping. The hit is defined in walk_along_ray, which does not know
 	// if it is looking for vertical or horizontal hits.
@@ -120,7 +120,23 @@ RayHit Grid::cast_ray(const Ray& r) const
 	}
 }
 
-RayHit Grid::cast_ray_horizontal(const Ray& r, const float tangent) const
+RayHit Grid::cast_ray_on_face(const Ray& r, const uint8_t cell_x, const uint8_t cell_z, const WallFace face) const
+{
+	const float tangent = std::abs(r.alpha.tan());
+
+	// Same as cast_ray, for the only direction that matters.
+	if (face == WallFace::BOTTOM || face == WallFace::TOP) {
+		RayHit hit = cast_ray_horizontal(r, tangent, cell_z, UNLIMITED);
+		hit.offset = (int) hit.x % cell_size;
+		return hit;
+	}
+
+	RayHit hit = cast_ray_vertical(r, tangent, cell_x, UNLIMITED);
+	hit.offset = (int) hit.z % cell_size;
+	return hit;
+}
+
+RayHit Grid::cast_ray_horizontal(const Ray& r, const float tangent, const int16_t target_row, const float max_distance) const
 {
 	const GridCoordinate starting_cell = cell_of(r.x, r.z);
 	const bool ray_goes_up = r.facing_up();
@@ -143,13 +159,20 @@ RayHit Grid::cast_ray_horizontal(const Ray& r, const float tangent) const
 		cell_size / tangent : 
 		- cell_size / tangent;
 
+	// The first point is in the row next to the start.
+	int16_t steps_to_wall = target_row == UNKNOWN ? UNKNOWN :
+		ray_goes_up ? target_row - (starting_cell.z + 1) : (starting_cell.z - 1) - target_row;
+	if (steps_to_wall < 0)
+		steps_to_wall = UNKNOWN;  // Not where it should be: search.
+
 	RayHit hit = walk_along_ray(r, first_point_x, first_point_z,
-		horizontal_step, vertical_step);
+		horizontal_step, vertical_step, steps_to_wall, max_distance);
 	hit.z -= push_into_lower_row;
+	hit.face = ray_goes_up ? WallFace::BOTTOM : WallFace::TOP;
 	return hit;
 }
 
-RayHit Grid::cast_ray_vertical(const Ray& r, const float tangent) const
+RayHit Grid::cast_ray_vertical(const Ray& r, const float tangent, const int16_t target_column, const float max_distance) const
 {
 	const GridCoordinate starting_cell = cell_of(r.x, r.z);
 	const bool ray_goes_up = r.facing_up();
@@ -173,9 +196,15 @@ RayHit Grid::cast_ray_vertical(const Ray& r, const float tangent) const
 		cell_size * tangent :
 		-cell_size * tangent;
 
+	int16_t steps_to_wall = target_column == UNKNOWN ? UNKNOWN :
+		ray_goes_right ? target_column - (starting_cell.x + 1) : (starting_cell.x - 1) - target_column;
+	if (steps_to_wall < 0)
+		steps_to_wall = UNKNOWN;
+
 	RayHit hit = walk_along_ray(r, first_point_x, first_point_z,
-		horizontal_step, vertical_step);
+		horizontal_step, vertical_step, steps_to_wall, max_distance);
 	hit.x -= push_into_previous_column;
+	hit.face = ray_goes_right ? WallFace::LEFT : WallFace::RIGHT;
 	return hit;
 
 }
@@ -190,27 +219,57 @@ RayHit Grid::walk_along_ray(const Ray& r,
 	                                 float candidate_point_x,
 									 float candidate_point_z, 
 									 const float horizontal_step,
-	                                 const float vertical_step) const
+	                                 const float vertical_step,
+	                                 const int16_t steps_to_wall,
+	                                 const float max_distance) const
 {
 	RayHit result;  // This is a no hit, by default.
 
+	if (steps_to_wall != UNKNOWN) {
+		// Exactly the same additions of the search, just without looking at the cells on the way.
+		for (int16_t step = 0; step < steps_to_wall; ++step) {
+			candidate_point_x += horizontal_step;
+			candidate_point_z += vertical_step;
+		}
+
+		const GridCoordinate wall_cell = cell_of(candidate_point_x, candidate_point_z);
+		result.x = candidate_point_x;
+		result.z = candidate_point_z;
+		result.distance = distance(candidate_point_x, candidate_point_z, r.x, r.z);
+		result.cell_x = wall_cell.x;
+		result.cell_z = wall_cell.z;
+		return result;
+	}
+
+	// The candidate points are evenly spaced on the ray: the number of steps within the max distance
+	// is known before starting. Then the loop only has to count.
+	float steps_left = UNLIMITED;
+	if (max_distance < UNLIMITED) {
+		const float first_point_distance = distance(candidate_point_x, candidate_point_z, r.x, r.z);
+		const float step_length = std::sqrt(horizontal_step * horizontal_step + vertical_step * vertical_step);
+		steps_left = std::floor((max_distance - first_point_distance) / step_length);
+	}
+
 	GridCoordinate candidate_point_cell = cell_of(candidate_point_x, candidate_point_z);
-	while (! candidate_point_cell.outside_world())
+	while (! candidate_point_cell.outside_world() && steps_left >= 0)
 	{
 		if (wall_at(candidate_point_cell.x, candidate_point_cell.z)) {
 			result.x = candidate_point_x;
 			result.z = candidate_point_z;
 			result.distance = distance(candidate_point_x, candidate_point_z, r.x, r.z);
+			result.cell_x = candidate_point_cell.x;
+			result.cell_z = candidate_point_cell.z;
 			return result;
 		}
 
 		candidate_point_x += horizontal_step;
 		candidate_point_z += vertical_step;
+		--steps_left;
 
 		candidate_point_cell = cell_of(candidate_point_x, candidate_point_z);
 	}
 
-	return result; // Outside.
+	return result; // Outside (of the world or of the view).
 }
 
 
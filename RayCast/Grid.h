@@ -57,13 +57,23 @@ namespace rc {
 
 		GridCoordinate cell_of(const float x, const float z) const noexcept;
 		WorldCoordinate center_of(uint8_t x, uint8_t z) const noexcept;
-		RayHit cast_ray(const Ray& r) const;
+
+		/** The ray stops looking for walls beyond the max distance (the view distance), so that the cost
+		of a ray is bounded even on a huge, open map. The walls further away are not hit. */
+		RayHit cast_ray(const Ray& r, const float max_distance = UNLIMITED) const;
+
+		/** Same result of cast_ray, when it is already known that the first wall on the ray is the given face.
+		The walk along the ray does the very same steps (and float roundings), but it does not look for walls
+		on the way. */
+		RayHit cast_ray_on_face(const Ray& r, const uint8_t cell_x, const uint8_t cell_z, const WallFace face) const;
 		bool close_to_walls(const float x, const float z, const float distance) const noexcept;
 
 		const uint8_t x_size;
 		const uint8_t z_size;
 		const uint8_t cell_size;
 
+		static constexpr float UNLIMITED = std::numeric_limits<float>::max();
+
 		/** This may not be optimal (in space and time), but sure it is a practical
 		structure to represent a grid of empty/full cells without bothering with the 
 		dimensions and the search methods. */ 
@@ -73,13 +83,19 @@ namespace rc {
 		const float max_x;  /// Useful to determine if an object is inside the grid. Cached at construction time.
 		const float max_z;
 
-		RayHit cast_ray_horizontal(const Ray& r, const float tangent) const;
-		RayHit cast_ray_vertical(const Ray& r, const float tangent) const;
+		/** Value for the target row/column and for the steps when the wall must be searched. */
+		static constexpr int16_t UNKNOWN = -1;
+
+		/** The target is the row (or column) of the wall, if already known. */
+		RayHit cast_ray_horizontal(const Ray& r, const float tangent, const int16_t target_row, const float max_distance) const;
+		RayHit cast_ray_vertical(const Ray& r, const float tangent, const int16_t target_column, const float max_distance) const;
 		RayHit walk_along_ray(const Ray& r,
 								       float candidate_point_x,
 									   float candidate_point_z,
 									   const float horizontal_step,
-									   const float vertical_step) const; 
+									   const float vertical_step,
+									   const int16_t steps_to_wall,
+									   const float max_distance) const; 
 
 		float distance(const float x1, const float z1, const float x2, const float z2) const;
 	};
@@ -2,6 +2,7 @@
 #include "KdTree.h"
 
 #include <algorithm>
+#include <cmath>
 #include <numeric>
 #include <limits>
 #include <stdexcept>
@@ -19,13 +20,19 @@ namespace rc {
 		if (objects.size() > std::numeric_limits<uint8_t>::max())
 			throw std::runtime_error("Too many objects, can not build tree.");
 				
+		root = KdTreeNode();
 		root.node_content = std::vector<uint8_t>(objects.size(), 0);
 		std::iota(root.node_content.begin(), root.node_content.end(), 0);
 		root.split(max_depth - 1, small_enough_size, objects);
 	}
 
 	std::vector<uint8_t> KdTree::intersect(const Ray& ray, const float cutoff_distance) const {
-		std::vector<uint8_t> hits = root.intersect(ray, cutoff_distance);
+		return intersect(ray, cutoff_distance, all_objects());
+	}
+
+	std::vector<uint8_t> KdTree::intersect(const Ray& ray, const float cutoff_distance, const ObjectBits& visible) const {
+		uint32_t visited_nodes = 0;
+		std::vector<uint8_t> hits = root.intersect(ray, cutoff_distance, visible, visited_nodes);
 
 		std::sort(hits.begin(), hits.end());
 		hits.erase(std::unique(hits.begin(), hits.end()), hits.end());
@@ -33,10 +40,35 @@ namespace rc {
 		return hits;
 	}
 
-	std::vector<uint8_t> KdTreeNode::intersect(const Ray& ray, const float cutoff_distance) const
+	KdTree::QueryCost KdTree::query_cost(const Ray& ray, const float cutoff_distance) const
+	{
+		QueryCost cost{ 0, 0 };
+		std::vector<uint8_t> hits = root.intersect(ray, cutoff_distance, all_objects(), cost.visited_nodes);
+
+		std::sort(hits.begin(), hits.end());
+		cost.candidates = (uint32_t) (std::unique(hits.begin(), hits.end()) - hits.begin());
+		return cost;
+	}
+
+	const ObjectBits& KdTree::all_objects() noexcept
+	{
+		static const ObjectBits all = ObjectBits().set();
+		return all;
+	}
+
+	std::vector<uint8_t> KdTreeNode::intersect(const Ray& ray, const float cutoff_distance, const ObjectBits& visible, uint32_t& visited_nodes) const
 	{ 
-		if (low == nullptr && high == nullptr)  // That is, this is a leaf node.
-			return node_content;
+		++visited_nodes;
+		if ((subtree_objects & visible).none())
+			return {};  // Nothing that can be seen down there.
+
+		if (low == nullptr && high == nullptr) {  // That is, this is a leaf node.
+			std::vector<uint8_t> visible_content;
+			for (const uint8_t object_index : node_content)
+				if (visible[object_index])
+					visible_content.push_back(object_index);
+			return visible_content;
+		}
 
 		const float ray_origin = (partition_direction == Partition::ON_X) ?
 			ray.x : ray.z;
@@ -44,27 +76,24 @@ namespace rc {
 		const bool goes_towards_high = (partition_direction == Partition::ON_X) ?
 			ray.facing_right() : ray.facing_up();
 
-		const float tangent = (partition_direction == Partition::ON_X) ?
-			std::tan(ray.alpha_rad) : 1 / std::tan(ray.alpha_rad);
-
 		std::vector<uint8_t> from_low, from_high;
 		Ray ray_other_side(0, 0, 0);
 		const float new_cutoff = ray_on_other_side(ray_other_side, ray, cutoff_distance);
 
 		if (ray_origin < split_value) {
-			from_low = low->intersect(ray, cutoff_distance);
+			from_low = low->intersect(ray, cutoff_distance, visible, visited_nodes);
 			if (new_cutoff > 0 && goes_towards_high)
-				from_high = high->intersect(ray_other_side, new_cutoff);
+				from_high = high->intersect(ray_other_side, new_cutoff, visible, visited_nodes);
 		}
 		else if (ray_origin > split_value) {
-			from_high = high->intersect(ray, cutoff_distance);
+			from_high = high->intersect(ray, cutoff_distance, visible, visited_nodes);
 			if (new_cutoff > 0 &&  ! goes_towards_high)
-				from_low = low->intersect(ray_other_side, new_cutoff);
+				from_low = low->intersect(ray_other_side, new_cutoff, visible, visited_nodes);
 		}
 		else
 		{
-			from_high = high->intersect(ray, cutoff_distance);
-			from_low = low->intersect(ray, cutoff_distance);
+			from_high = high->intersect(ray, cutoff_distance, visible, visited_nodes);
+			from_low = low->intersect(ray, cutoff_distance, visible, visited_nodes);
 		}
 
 		// Merge vectors to return all values.
@@ -74,6 +103,9 @@ namespace rc {
 
 	void KdTreeNode::split(const uint8_t depth, const uint8_t small_enough_size, const std::vector<Sprite>& objects_collection)
 	{
+		for (const uint8_t object_index : node_content)
+			subtree_objects.set(object_index);
+
 		if (depth == 0)
 			return; // Max depth reached, can not split further.
 
@@ -157,28 +189,29 @@ namespace rc {
 		//       The only exception is the wall intersection, but it is just a matter of starting with a very high value...
 		//       It also avoids the output parameter for the new cutoff distance here.
 
-		// This way the horyzontal or vertical intersection "look" the same.
-		const float tangent = (partition_direction == Partition::ON_X) ?
-			std::tan(ray_this_side.alpha_rad) : 1 / std::tan(ray_this_side.alpha_rad);
+		// Walk along the ray up to the split line. The direction cosine on the split axis tells how long the walk is.
+		const float cos_alpha = ray_this_side.alpha.cos();
+		const float sin_alpha = ray_this_side.alpha.sin();
+		const float axis_cosine = std::abs((partition_direction == Partition::ON_X) ? cos_alpha : sin_alpha);
 
 		const float distance_from_split = std::abs(ray_origin - split_value);
-		const float height_over_ray = distance_from_split * tangent;
 
 		// TODO: can we do the whole search using only squared distances?
-		const float distance_to_cross_point = std::sqrt(distance_from_split * distance_from_split + height_over_ray * height_over_ray);  // I have this formula all over the place. TODO!
+		// Parallel rays never cross: the division gives infinity, which is never below the cutoff.
+		const float distance_to_cross_point = distance_from_split / axis_cosine;
 
 		if (distance_to_cross_point < original_cutoff_distance) {
 			const float new_cutoff = original_cutoff_distance - distance_to_cross_point;  // The ray has to walk "the rest of the way".
 
 			const float new_ray_x = (partition_direction == Partition::ON_X) ?
-				split_value : ray_this_side.x + height_over_ray;
+				split_value : ray_this_side.x + distance_to_cross_point * cos_alpha;
 
 			const float new_ray_z = (partition_direction == Partition::ON_X) ?
-				ray_this_side.z + height_over_ray : split_value;
+				ray_this_side.z + distance_to_cross_point * sin_alpha : split_value;
 
 			ray_other_side.x = new_ray_x;
 			ray_other_side.z = new_ray_z;
-			ray_other_side.alpha_rad = ray_this_side.alpha_rad;
+			ray_other_side.alpha = ray_this_side.alpha;
 
 			return new_cutoff;
 		}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <bitset>
 #include <memory>
 #include <vector>
 
@@ -8,6 +9,9 @@
 
 namespace rc {
 
+	/** One bit for each object of a collection, by index. The KdTree indexes are uint8_t, 256 bits are enough. */
+	using ObjectBits = std::bitset<256>;
+
 	/** "Inner class" for the KdTree. Refer to that class to know what is going on.
 	The tree and the nodes are in different classes to avoid multiple copies of fields and to
 	do certain operations only at the end of the intersection recursion.
@@ -24,7 +28,14 @@ namespace rc {
 			ON_X, ON_Z
 		};
 
-		std::vector<uint8_t> intersect(const Ray& ray, const float cutoff_distance) const;
+		std::vector<uint8_t> intersect(const Ray& ray, const float cutoff_distance, const ObjectBits& visible, uint32_t& visited_nodes) const;
+
+		/** Recursion of KdTree::closest_hit.
+		The segment is the part of the ray that goes across this node. It starts travelled units away from the ray origin
+		and is segment_cutoff long. The hits are always computed on the full ray, to have the real distances.*/
+		template <typename ACCEPT>
+		void closest_hit(const Ray& ray, const Ray& segment, const float travelled, const float segment_cutoff,
+			const std::vector<Sprite>& objects_collection, const ObjectBits& visible, ACCEPT& accept, RayHit& closest) const;
 
 		/** For the recursive tree construction. Divides the node content in the sub trees.*/
 		void split(const uint8_t depth, const uint8_t small_enough_size, const std::vector<Sprite>& object_collection);
@@ -40,6 +51,9 @@ namespace rc {
 		*/
 		std::vector<uint8_t> node_content;
 
+		/** All the objects in this node and below, to skip the whole subtree if none of them can be seen. */
+		ObjectBits subtree_objects;
+
 	private:
 		/** Tells on what direction (x/z) the objects in the node extend the most.
 		It also set the split value - it is computed easily as part of the partition direction calculation.
@@ -77,7 +91,7 @@ namespace rc {
 	class KdTree {
 	public:
 
-		/** Creates the tree structure.
+		/** Creates the tree structure, replacing the previous one if any.
 		It may not be the fastets implementation, but in this game all the objects are static:
 		the tree is build only once, at startup. No need to worry. */
 		void build(const uint8_t max_depth, const uint8_t small_enough_size);
@@ -88,6 +102,35 @@ namespace rc {
 		Assumes that there was a call to build() before usage. But it does not check, for speed.*/
 		std::vector<uint8_t> intersect(const Ray& ray, const float cutoff_distance) const;
 
+		/** Same, only for the visible objects (see PotentiallyVisibleSet). The subtrees without any are skipped. */
+		std::vector<uint8_t> intersect(const Ray& ray, const float cutoff_distance, const ObjectBits& visible) const;
+
+		/** Returns the hit on the closest active object that the accept function likes (e. g. where the pixel is not
+		transparent), or a no-hit if there is nothing closer than the cutoff.
+
+		Unlike intersect(), this visits the nodes in order of distance from the ray origin: first the one where the
+		ray starts, then the one on the other side of the split. The other side is skipped if there is already a hit
+		before the ray crosses the split. No vectors, no sorting: meant for hit-scan shooting.
+
+		ACCEPT is anything that can be called as bool accept(const RayHit& hit).*/
+		template <typename ACCEPT>
+		RayHit closest_hit(const Ray& ray, const float cutoff_distance, ACCEPT accept) const;
+
+		/** Same, only for the visible objects. */
+		template <typename ACCEPT>
+		RayHit closest_hit(const Ray& ray, const float cutoff_distance, const ObjectBits& visible, ACCEPT accept) const;
+
+		/** All the bits set: every object is visible. */
+		static const ObjectBits& all_objects() noexcept;
+
+		/** The work of an intersect() call: the nodes it went through and the objects left to test one by one.
+		Only to estimate what the tree is worth (see Objects::prepare_broad_phase). */
+		struct QueryCost {
+			uint32_t visited_nodes;
+			uint32_t candidates;
+		};
+		QueryCost query_cost(const Ray& ray, const float cutoff_distance) const;
+
 		/** Actual storage of the objects in space.
 		For simplicity, the root holds the objects. The tree nodes refer to it via an index (position) 
 		in the vector. Using the object requires an extra lookup (given the index, find the object),
@@ -98,4 +141,77 @@ namespace rc {
 		Ideally, it would be private. But I need to test the tree structure, so this has to be accessible.*/
 		KdTreeNode root;
 	};
+
+
+	template <typename ACCEPT>
+	RayHit KdTree::closest_hit(const Ray& ray, const float cutoff_distance, ACCEPT accept) const
+	{
+		return closest_hit(ray, cutoff_distance, all_objects(), accept);
+	}
+
+	template <typename ACCEPT>
+	RayHit KdTree::closest_hit(const Ray& ray, const float cutoff_distance, const ObjectBits& visible, ACCEPT accept) const
+	{
+		RayHit closest;  // No hit, to begin with.
+		root.closest_hit(ray, ray, 0, cutoff_distance, objects, visible, accept, closest);
+		return closest;
+	}
+
+	template <typename ACCEPT>
+	void KdTreeNode::closest_hit(const Ray& ray, const Ray& segment, const float travelled, const float segment_cutoff,
+		const std::vector<Sprite>& objects_collection, const ObjectBits& visible, ACCEPT& accept, RayHit& closest) const
+	{
+		if ((subtree_objects & visible).none())
+			return;  // Nothing that can be seen down there.
+
+		if (low == nullptr && high == nullptr) {  // Leaf: the objects are not sorted, must try them all.
+			for (const uint8_t object_index : node_content) {
+				const Sprite& candidate = objects_collection[object_index];
+				if (!candidate.active || !visible[object_index])
+					continue;
+
+				const RayHit hit = candidate.intersection(ray);
+				if (hit.really_hit() &&
+					hit.distance < travelled + segment_cutoff &&
+					(closest.no_hit() || hit.distance < closest.distance) &&
+					accept(hit))
+					closest = hit;
+			}
+			return;
+		}
+
+		const float segment_origin = (partition_direction == Partition::ON_X) ?
+			segment.x : segment.z;
+
+		const bool goes_towards_high = (partition_direction == Partition::ON_X) ?
+			segment.facing_right() : segment.facing_up();
+
+		if (segment_origin == split_value) {  // Can't tell which side is closer. Rare enough to look at both.
+			low->closest_hit(ray, segment, travelled, segment_cutoff, objects_collection, visible, accept, closest);
+			high->closest_hit(ray, segment, travelled, segment_cutoff, objects_collection, visible, accept, closest);
+			return;
+		}
+
+		const bool starts_low = segment_origin < split_value;
+		const KdTreeNode& near_side = starts_low ? *low : *high;
+		const KdTreeNode& far_side = starts_low ? *high : *low;
+
+		near_side.closest_hit(ray, segment, travelled, segment_cutoff, objects_collection, visible, accept, closest);
+
+		if (starts_low != goes_towards_high)
+			return;  // Going away from the split, never reaches the other side.
+
+		Ray segment_other_side(0, 0, 0);
+		const float other_side_cutoff = ray_on_other_side(segment_other_side, segment, segment_cutoff);
+		if (other_side_cutoff <= 0)
+			return;  // The split is beyond the cutoff.
+
+		// An object hit before the split is also in the near side (nodes contain everything that overlaps them).
+		// If a hit is already closer than the split, nothing on the other side can beat it.
+		const float split_crossing = travelled + segment_cutoff - other_side_cutoff;
+		if (closest.really_hit() && closest.distance <= split_crossing)
+			return;
+
+		far_side.closest_hit(ray, segment_other_side, split_crossing, other_side_cutoff, objects_collection, visible, accept, closest);
+	}
 }
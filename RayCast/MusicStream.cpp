@@ -0,0 +1,78 @@
+#include "pch.h"
+#include "MusicStream.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace rc {
+
+	MusicStream::MusicStream(std::unique_ptr<std::istream> source, const uint32_t buffer_frames) :
+		buffer_frames(std::max(buffer_frames, (uint32_t) 1)),
+		source(std::move(source)),
+		reader(*this->source),
+		ring((size_t) this->buffer_frames * 2),
+		taken_position(0),
+		written_position(0)
+	{
+		if (reader.frames == 0)
+			throw std::runtime_error("No music in the wav file.");
+
+		refill();
+	}
+
+	uint32_t MusicStream::refill()
+	{
+		uint64_t written = written_position.load(std::memory_order_relaxed);
+		uint32_t free_frames = buffer_frames - (uint32_t) (written - taken_position.load(std::memory_order_acquire));
+		uint32_t frames_read = 0;
+
+		while (free_frames > 0) {
+			// Up to the end of the ring, the next piece starts again from its beginning.
+			const uint32_t ring_frame = (uint32_t) (written % buffer_frames);
+			const uint32_t piece = std::min(free_frames, buffer_frames - ring_frame);
+
+			uint32_t piece_read = reader.read(ring.data() + (size_t) ring_frame * 2, piece);
+			if (piece_read == 0) {
+				reader.rewind();
+				piece_read = reader.read(ring.data() + (size_t) ring_frame * 2, piece);
+				if (piece_read == 0)
+					break;  // Nothing more in the file, not even from the start.
+			}
+
+			written += piece_read;
+			free_frames -= piece_read;
+			frames_read += piece_read;
+			written_position.store(written, std::memory_order_release);  // The audio can take them already.
+		}
+
+		return frames_read;
+	}
+
+	uint32_t MusicStream::take(int16_t* stereo_samples, const uint32_t frames) noexcept
+	{
+		uint64_t taken = taken_position.load(std::memory_order_relaxed);
+		const uint32_t available = (uint32_t) std::min((uint64_t) frames, written_position.load(std::memory_order_acquire) - taken);
+
+		uint32_t copied = 0;
+		while (copied < available) {
+			const uint32_t ring_frame = (uint32_t) ((taken + copied) % buffer_frames);
+			const uint32_t piece = std::min(available - copied, buffer_frames - ring_frame);
+			std::copy_n(ring.begin() + (size_t) ring_frame * 2, (size_t) piece * 2, stereo_samples + (size_t) copied * 2);
+			copied += piece;
+		}
+		taken_position.store(taken + available, std::memory_order_release);
+
+		std::fill(stereo_samples + (size_t) available * 2, stereo_samples + (size_t) frames * 2, 0);
+		return available;
+	}
+
+	uint32_t MusicStream::buffered_frames() const noexcept
+	{
+		return (uint32_t) (written_position.load(std::memory_order_acquire) - taken_position.load(std::memory_order_acquire));
+	}
+
+	uint32_t MusicStream::frequency() const noexcept
+	{
+		return reader.frequency;
+	}
+}
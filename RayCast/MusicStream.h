@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <vector>
+
+#include "WavReader.h"
+
+namespace rc {
+
+	/** Music read from its file while it plays, instead of loaded whole: only a ring of buffer_frames is in memory,
+	however long the track, and opening it reads just the header and the first ring.
+
+	Two threads, without locks: the refill thread reads the file ahead of the audio (refill), the audio callback
+	takes the frames (take). Same scheme of the SpscQueue, in bulk: the positions count the frames ever written and
+	taken, the place in the ring is the position modulo its size.
+
+	The music loops: at the end of the file the refill starts again from the beginning, the audio does not notice.
+	If the audio takes faster than the refill reads (slow disk, starved refill thread), the frames not there yet are
+	silence: a glitch, never a wait in the audio thread.
+	*/
+	class MusicStream {
+	public:
+		/** Reads the header and fills the ring once, so that the music can start at once.
+		Throws if the source is not a wav that the WavReader understands, or if it has no frames. */
+		MusicStream(std::unique_ptr<std::istream> source, const uint32_t buffer_frames);
+
+		MusicStream(const MusicStream&) = delete;
+		MusicStream& operator=(const MusicStream&) = delete;
+
+		/** Refill thread only. Reads from the file until the ring is full, returns the frames read. */
+		uint32_t refill();
+
+		/** Audio thread only. Fills the frames (2 samples each) with the next ones of the ring, silence for those
+		not read yet. Returns how many were there. */
+		uint32_t take(int16_t* stereo_samples, const uint32_t frames) noexcept;
+
+		/** Read and not taken yet. */
+		uint32_t buffered_frames() const noexcept;
+
+		uint32_t frequency() const noexcept;
+
+		const uint32_t buffer_frames;
+
+	private:
+		std::unique_ptr<std::istream> source;
+		WavReader reader;
+		std::vector<int16_t> ring;
+
+		// On different cache lines: the two threads do not invalidate each other's cache for nothing.
+		alignas(64) std::atomic<uint64_t> taken_position;  /// Written by the audio thread only.
+		alignas(64) std::atomic<uint64_t> written_position;  /// Written by the refill thread only.
+	};
+}
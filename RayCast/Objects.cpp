@@ -2,29 +2,43 @@
 #include "Objects.h"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
 #include <stdexcept>
 
+#include "PI.h"
+
 namespace rc {
 
+	const VisibleObjects& VisibleObjects::all() noexcept
+	{
+		static const VisibleObjects everything{ KdTree::all_objects(), KdTree::all_objects() };
+		return everything;
+	}
+
 	std::vector<RayHit> Objects::all_intersections(const Ray& ray, const RayHit& cutoff, const uint8_t enumerated_kinds) const noexcept
+	{
+		return all_intersections(ray, cutoff, enumerated_kinds, VisibleObjects::all());
+	}
+
+	std::vector<RayHit> Objects::all_intersections(const Ray& ray, const RayHit& cutoff, const uint8_t enumerated_kinds, const VisibleObjects& visible) const noexcept
 	{
 		std::vector<RayHit> valid_hits;  // Do not reserve. There are few interesction at the same time, not worth it.
 
 		if (enumerated_kinds & (uint8_t)TextureIndex::ENEMY) {
 			// TODO assert(tree was built)
 
-			const auto broad_phase_hits = enemies.intersect(ray, cutoff.distance);
-			const std::vector<RayHit> hits = intersections(ray, cutoff, broad_phase_hits);
-			//std::cout << "BF " << broad_phase_hits.size() << " NF " << hits.size() << "\n";
-			
-			// Unoptimized code, to compare... Notice that when there are few enemies this is way faster!
-			//const std::vector<RayHit> hits = intersections(ray, cutoff, enemies.objects);
+			// With few enemies the tree is slower than trying them all. See prepare_broad_phase.
+			const std::vector<RayHit> hits = broad_phase.strategy == BroadPhase::KD_TREE ?
+				intersections(ray, cutoff, enemies.intersect(ray, cutoff.distance, visible.enemies)) :
+				intersections(ray, cutoff, enemies.objects, visible.enemies);
 
 			valid_hits.insert(valid_hits.end(), hits.begin(), hits.end());
 		}
 
 		if (enumerated_kinds & (uint8_t)TextureIndex::EXIT) {
-			const std::vector<RayHit> hits = intersections(ray, cutoff, exits);
+			const std::vector<RayHit> hits = intersections(ray, cutoff, exits, visible.exits);
 			valid_hits.insert(valid_hits.end(), hits.begin(), hits.end());
 		}
 
@@ -37,6 +51,99 @@ namespace rc {
 		return valid_hits;
 	}
 
+	void Objects::prepare_broad_phase()
+	{
+		const BroadPhaseSettings linear{ BroadPhase::LINEAR, 0, 0 };
+		linear_cost = estimate_cost(linear);
+
+		BroadPhaseSettings best = linear;
+		float best_cost = linear_cost;
+
+		const size_t enemy_count = enemies.objects.size();
+		for (const uint8_t leaf_size : { 1, 2, 4, 8, 16, 32 }) {
+			if (leaf_size >= enemy_count)
+				break;  // A single leaf, that is a linear scan with extra steps.
+
+			// Deep enough to get down to the leaf size, and a bit more for the objects that straddle the splits.
+			const uint8_t depth = (uint8_t) std::min(std::ceil(std::log2((float) enemy_count / leaf_size)) + 2, 20.0f);
+			const BroadPhaseSettings tree{ BroadPhase::KD_TREE, depth, leaf_size };
+			const float cost = estimate_cost(tree);
+
+			constexpr float worth_the_trouble = 0.8f;  // The linear scan is simpler, and kinder to the cache.
+			if (cost < best_cost && cost < linear_cost * worth_the_trouble) {
+				best = tree;
+				best_cost = cost;
+			}
+		}
+
+		prepare_broad_phase(best);
+	}
+
+	void Objects::prepare_broad_phase(const BroadPhaseSettings& forced)
+	{
+		if (forced.strategy == BroadPhase::KD_TREE && forced.max_depth == 0)
+			throw std::runtime_error("Kd tree depth must be at least one.");
+
+		linear_cost = estimate_cost(BroadPhaseSettings{ BroadPhase::LINEAR, 0, 0 });
+		broad_phase_cost = estimate_cost(forced);  // Builds the tree, if needed.
+		broad_phase = forced;
+
+		if (forced.strategy == BroadPhase::LINEAR)
+			enemies.build(1, 255);  // A single leaf: the tree is not used, but it must be in a valid state.
+	}
+
+	std::string Objects::broad_phase_report() const
+	{
+		std::ostringstream report;
+		report << enemies.objects.size() << " enemies, broad phase: ";
+		if (broad_phase.strategy == BroadPhase::LINEAR)
+			report << "linear";
+		else
+			report << "KdTree, depth " << (int) broad_phase.max_depth << ", leaves of " << (int) broad_phase.leaf_size;
+		report << ". Cost per ray " << broad_phase_cost << " sprite tests, linear " << linear_cost << ".";
+		return report.str();
+	}
+
+	/** The rays start all over the area of the enemies, in all directions, and go half across it.
+	Deterministic, so that the same level always gets the same choice. */
+	float Objects::estimate_cost(const BroadPhaseSettings& settings)
+	{
+		if (enemies.objects.empty())
+			return 0;
+
+		if (settings.strategy == BroadPhase::LINEAR)
+			return (float) enemies.objects.size();
+
+		enemies.build(settings.max_depth, settings.leaf_size);
+
+		float min_x = std::numeric_limits<float>::max();
+		float min_z = std::numeric_limits<float>::max();
+		float max_x = std::numeric_limits<float>::lowest();
+		float max_z = std::numeric_limits<float>::lowest();
+		for (const Sprite& enemy : enemies.objects) {
+			min_x = std::min(enemy.x - enemy.size, min_x);
+			min_z = std::min(enemy.z - enemy.size, min_z);
+			max_x = std::max(enemy.x + enemy.size, max_x);
+			max_z = std::max(enemy.z + enemy.size, max_z);
+		}
+		const float reach = std::hypot(max_x - min_x, max_z - min_z) / 2;
+
+		constexpr uint16_t sample_rays = 64;
+		float total_cost = 0;
+		for (uint16_t i = 0; i < sample_rays; ++i) {
+			// Low discrepancy sequences, to spread the samples evenly.
+			const float u = std::fmod(i * 0.618034f, 1.0f);
+			const float v = std::fmod(i * 0.754878f + 0.5f, 1.0f);
+			const float w = std::fmod(i * 0.569840f + 0.25f, 1.0f);
+			const Ray ray(min_x + u * (max_x - min_x), min_z + v * (max_z - min_z), w * 2 * PI);
+
+			const KdTree::QueryCost cost = enemies.query_cost(ray, reach);
+			total_cost += cost.candidates + cost.visited_nodes * NODE_VISIT_COST;
+		}
+
+		return total_cost / sample_rays;
+	}
+
 	void Objects::deactivate(const uint8_t sprite_id)  // TODO! Mark that this is only for enemies!!!
 	{
 		const auto to_be_shut_off = std::find_if(enemies.objects.begin(), enemies.objects.end(),
@@ -71,11 +178,12 @@ namespace rc {
 
 	}
 
-	std::vector<RayHit> Objects::intersections(const Ray& ray, const RayHit& cutoff, const std::vector<Sprite>& objects) const
+	std::vector<RayHit> Objects::intersections(const Ray& ray, const RayHit& cutoff, const std::vector<Sprite>& objects, const ObjectBits& visible) const
 	{
 		std::vector<RayHit> hits;
-		for (const Sprite& sprite : objects) {
-			if (!sprite.active)  // ALSO todo: can't deactivate landmarks... can I hide the exits?
+		for (size_t i = 0; i < objects.size(); ++i) {
+			const Sprite& sprite = objects[i];
+			if (!sprite.active || (i < visible.size() && !visible[i]))  // ALSO todo: can't deactivate landmarks... can I hide the exits?
 				continue;
 
 			RayHit candidate_hit = sprite.intersection(ray);
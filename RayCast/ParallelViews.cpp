@@ -0,0 +1,108 @@
+#include "pch.h"
+#include "ParallelViews.h"
+
+namespace rc {
+
+	ParallelViews::ParallelViews(const uint8_t worker_threads) :
+		frame_world(nullptr),
+		frame(0),
+		frame_views(0),
+		views_done(0),
+		stopping(false),
+		next_claim(0)
+	{
+		for (uint8_t i = 0; i < worker_threads; ++i)
+			workers.emplace_back(&ParallelViews::work, this);
+	}
+
+	ParallelViews::~ParallelViews()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		work_available.notify_all();
+
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	static constexpr uint64_t CLAIM_INDEX_MASK = 0xFFFFFFFF;
+
+	void ParallelViews::prepare_all(const World& world)
+	{
+		uint64_t this_frame;
+		size_t view_count;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			frame_world = &world;
+			frame_views = views.size();
+			views_done = 0;
+			this_frame = ++frame;
+			view_count = frame_views;
+			next_claim = this_frame << 32;
+		}
+		work_available.notify_all();
+
+		prepare_views(world, this_frame, view_count);  // The calling thread does its share, instead of just waiting.
+
+		std::unique_lock<std::mutex> lock(mutex);
+		work_done.wait(lock, [this, view_count] { return views_done == view_count; });
+	}
+
+	void ParallelViews::work()
+	{
+		uint64_t last_frame = 0;
+
+		while (true) {
+			const World* world;
+			size_t view_count;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				work_available.wait(lock, [this, last_frame] { return stopping || frame != last_frame; });
+				if (stopping)
+					return;
+				last_frame = frame;
+				world = frame_world;
+				view_count = frame_views;
+			}
+
+			prepare_views(*world, last_frame, view_count);
+		}
+	}
+
+	/** Takes the views not taken yet by the other threads, one at a time, until there are none left.
+	A thread late for its frame finds no views: the views are all claimed, or the claims are of the next frame. */
+	void ParallelViews::prepare_views(const World& world, const uint64_t frame_number, const size_t view_count)
+	{
+		size_t prepared = 0;
+
+		size_t index;
+		while (claim_view(frame_number, view_count, index)) {
+			const View& view = views[index];
+			view.plane->prepare(world, view.camera);
+			++prepared;
+		}
+
+		if (prepared == 0)
+			return;
+
+		// The frame can not end before its views are counted: this is still the frame of the claims.
+		std::lock_guard<std::mutex> lock(mutex);
+		views_done += prepared;
+		if (views_done == frame_views)
+			work_done.notify_all();
+	}
+
+	bool ParallelViews::claim_view(const uint64_t frame_number, const size_t view_count, size_t& index) noexcept
+	{
+		uint64_t claim = next_claim.load();
+		do {
+			if ((claim >> 32) != (frame_number & CLAIM_INDEX_MASK) || (claim & CLAIM_INDEX_MASK) >= view_count)
+				return false;
+		} while (!next_claim.compare_exchange_weak(claim, claim + 1));
+
+		index = (size_t) (claim & CLAIM_INDEX_MASK);
+		return true;
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Camera.h"
+#include "ProjectionPlane.h"
+#include "Viewport.h"
+#include "World.h"
+
+namespace rc {
+
+	/** What a plane shows and where: the camera it looks from and the corner of its rectangle on the canvas. */
+	struct View {
+		ProjectionPlane* plane;  /// Not owned. In one view only: it keeps the frame it prepared until it is drawn.
+		Camera camera;
+		uint16_t left;
+		uint16_t top;
+	};
+
+
+	/** Several views of the same world in one canvas: split screen, rear-view mirror...
+
+	Every frame, the planes prepare their view at the same time, on worker threads and on the calling thread
+	(see ProjectionPlane::prepare). They only read the world, so the grid, the sprites and the potentially visible
+	set are shared by all of them. Then they draw one after the other, each in its viewport, in the order of
+	the views (the picture in picture goes last, on top). Only the calling thread touches the canvas: it does not
+	need to be thread safe.
+
+	The worker threads wait on a condition variable between the frames: no thread is created during the game.
+	*/
+	class ParallelViews {
+	public:
+		/** With 0 worker threads, everything runs on the calling thread. */
+		explicit ParallelViews(const uint8_t worker_threads);
+		~ParallelViews();
+
+		ParallelViews(const ParallelViews&) = delete;
+		ParallelViews& operator=(const ParallelViews&) = delete;
+
+		/** Do not change them during project_objects. */
+		std::vector<View> views;
+
+		template <typename CANVAS>
+		void project_objects(const World& world, CANVAS& canvas);
+
+		/** The first half of project_objects: returns when all the views are prepared. */
+		void prepare_all(const World& world);
+
+	private:
+		std::vector<std::thread> workers;
+		std::mutex mutex;
+		std::condition_variable work_available;
+		std::condition_variable work_done;
+
+		/** All protected by the mutex, but next_claim that the threads use to share the views.
+		A worker copies the state of the frame when it wakes up, it never looks at the views vector to know
+		how many there are: the owner may resize it between the frames. */
+		const World* frame_world;
+		uint64_t frame;  /// Counts the frames, so that the workers know when there is a new one.
+		size_t frame_views;  /// How many views the frame has.
+		size_t views_done;
+		bool stopping;
+
+		/** The frame in the high 32 bits, the next view to prepare in the low ones: a worker late for a frame
+		can not take a view of the next one. */
+		std::atomic<uint64_t> next_claim;
+
+		void work();
+		void prepare_views(const World& world, const uint64_t frame_number, const size_t view_count);
+
+		/** Takes the next view of the frame, false if there are none left or the frame is over. */
+		bool claim_view(const uint64_t frame_number, const size_t view_count, size_t& index) noexcept;
+	};
+
+
+	template <typename CANVAS>
+	void ParallelViews::project_objects(const World& world, CANVAS& canvas)
+	{
+		prepare_all(world);
+
+		for (const View& view : views) {
+			Viewport<CANVAS> viewport(canvas, view.left, view.top, view.plane->rows);
+			view.plane->draw(viewport);
+		}
+	}
+}
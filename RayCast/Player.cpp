@@ -1,20 +1,18 @@
 #include "pch.h"
 #include "Player.h"
 
-#include <cmath>
+#include <limits>
 
 #include "Loudspeaker.h"
-#include "PI.h"
 
 
 namespace rc {
 	
-	void Player::advance(const float axis, const Grid& map) noexcept
+	void Player::advance(const float axis, const float seconds, const Grid& map) noexcept
 	{
-		constexpr float advance_speed = 5.0f;   /// Distance units per key press.
-
-		const float z_step = std::sin(orientation) * advance_speed * axis;
-		const float x_step = std::cos(orientation) * advance_speed * axis;
+		const float distance = ADVANCE_SPEED * seconds * axis;
+		const float z_step = orientation.sin() * distance;
+		const float x_step = orientation.cos() * distance;
 
 		const float future_position_x = x_position + x_step;
 		const float future_position_z = z_position + z_step;
@@ -33,41 +31,40 @@ namespace rc {
 		x_position = future_position_x;
 	}
 
-	void Player::turn(const float axis) noexcept
+	void Player::turn(const float axis, const float seconds) noexcept
+	{
+		// No need to normalize between 0 and 2 PI: the binary angle wraps around.
+		// (There was a "severe" clamp here, negative angles went to 2PI no matter how much behind 0 they were.
+		// In practice it worked, you did not see jitter in the game).
+		orientation += BinaryAngle(TURN_SPEED * seconds * axis);
+	}
+
+	Camera Player::camera() const noexcept
 	{
-		constexpr float turn_speed = 0.045f;   /// Circa degrees per frame.
-
-		orientation += turn_speed * axis;
-
-		// Normalize between 0 and 2 PI, like all the angles in the project.
-		// Notice that the clamping is really "severe" (e. g. negative angles
-		// go to 2PI, no matter how much behind 0 they are), but in practice
-		// it works. You don't see jitter in the game.
-		// This is surprising enough - keep this code as a "memento".
-		if (orientation < 0)
-			orientation = 2 * PI;
-		if (orientation > 2 * PI)
-			orientation = 0;
+		return Camera{ x_position, z_position, orientation };
 	}
 
-	void Player::shoot(const Grid& map, Objects& targets, const Canvas& image_tester, Loudspeaker& sfx) noexcept
+	void Player::shoot(const Grid& map, Objects& targets, const AlphaMasks& target_masks, Loudspeaker& sfx,
+		const VisibleObjects& visible_targets) noexcept
 	{
 		if (bullets_left == 0)
 			return;
 
 		const Ray gun_ray(x_position, z_position, orientation);
-		const RayHit max_range = map.cast_ray(gun_ray);
-
-		const std::vector<RayHit> hits_targets = targets.all_intersections(gun_ray, max_range, (uint8_t)TextureIndex::ENEMY);
+		const RayHit wall_hit = map.cast_ray(gun_ray);
+		const float max_range = wall_hit.really_hit() ? wall_hit.distance : std::numeric_limits<float>::max();
 
-		// Reverse-iterate: the bullet shoud hit only the closest target.
-		for (auto hit = hits_targets.rbegin(); hit != hits_targets.rend(); ++hit)
-			if (!image_tester.transparent_pixel(hit->offset, 32, TextureIndex::ENEMY)) {  // TODO: remove gun height hardcode. Also, is this "in tune" with the projection? Do I have to do something like WC -> local coordinates change? And what if I introduce different enemies?
-				targets.deactivate(hit->hit_object_id);
-				++kills;  // Optimistically assume we never overflow, there are not that many targets.
-			
-				break;  // One hit per bullet. The ray casting does not halt on non-transparent pixels.
+		// The bullet shoud hit only the closest target. Shooting through the transparent pixels.
+		const RayHit target_hit = targets.closest_enemy(gun_ray, max_range, visible_targets,
+			[&target_masks](const RayHit& hit) {
+				return target_masks.of(hit.type).opaque(hit.offset, 32);  // TODO: remove gun height hardcode. Also, is this "in tune" with the projection? Do I have to do something like WC -> local coordinates change? And what if I introduce different enemies?
 			}
+		);
+
+		if (target_hit.really_hit()) {
+			targets.deactivate(target_hit.hit_object_id);
+			++kills;  // Optimistically assume we never overflow, there are not that many targets.
+		}
 
 		--bullets_left;
 		sfx.play_sound(SoundIndex::GUN_SHOT);
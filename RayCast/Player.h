@@ -2,6 +2,9 @@
 
 #include<cstdint>
 
+#include "AlphaMask.h"
+#include "BinaryAngle.h"
+#include "Camera.h"
 #include "Canvas.h"
 #include "Grid.h"
 #include "Objects.h"
@@ -12,32 +15,38 @@ namespace rc {
 
 	/** Simplifed-to-the-bone class to represent the player character. Position and movement.
 		
-		Since SDL should take care of the frame rate and v-synch it to the screen refresh rate,
-		I can imagine that each game loop has a fixed duration.
-		It is reasonable to assume that the framerate won't drop too much below 60 FPS on a modern
-		PC, given how simple the code is.
-
-		Therefore, the movement function only take the direction, without the frame duration.
+		The speeds are per second, the movement functions take the direction and the time it lasts.
+		The game loop calls them once for each step of the simulation (see FixedTimestep), not once for
+		each frame: the game goes at the same speed whatever the frame rate.
 
 		Player-wall collisions ignored on purpose, not part of this exercise (it would not be too difficult 
 		to implement them just using the grid, or reusing the ray cast to find the distance to the nearest wall).
 
 		The position is directly in world coordinates. The orientation is absolute (0 means "toward +X",
-		PI is "towards -X"...).
+		PI is "towards -X"...). It is a BinaryAngle, so it wraps around by itself while turning.
 	*/
 	class Player
 	{
 	public:
-		void advance(const float axis, const Grid& map) noexcept;
-		void turn(const float axis) noexcept;
-		void shoot(const Grid& map, Objects& targets, const Canvas& image_tester, Loudspeaker& sfx) noexcept;
+		/** Axis 1 is forward, -1 backward. Does not move at all if it would end up too close to a wall. */
+		void advance(const float axis, const float seconds, const Grid& map) noexcept;
+		/** Axis 1 turns towards the growing angles. */
+		void turn(const float axis, const float seconds) noexcept;
+		/** The view from the eyes of the player. */
+		Camera camera() const noexcept;
+		/** Only the visible targets can be hit (see PotentiallyVisibleSet). */
+		void shoot(const Grid& map, Objects& targets, const AlphaMasks& target_masks, Loudspeaker& sfx,
+			const VisibleObjects& visible_targets = VisibleObjects::all()) noexcept;
 
 		float x_position;
 		float z_position;
-		float orientation;
+		BinaryAngle orientation;
 
 		uint8_t bullets_left;
 		uint8_t kills = 0;
+
+		static constexpr float ADVANCE_SPEED = 300;  /// Distance units per second.
+		static constexpr float TURN_SPEED = 2.7f;  /// Radians per second.
 	};
 
 }
@@ -0,0 +1,301 @@
+#include "pch.h"
+#include "PotentiallyVisibleSet.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace rc {
+
+	/** The lines of sight are checked on a finer grid, with this many fine cells on the side of a grid cell. */
+	static constexpr int32_t FINE_CELLS = 4;
+
+	/** The walls on the fine grid, shrunk by one fine cell where they touch empty space. A fine cell stays solid
+	only if it and its 8 neighbours are all inside walls: then anything less than a fine cell away from it is inside
+	a wall too. Outside the grid counts as wall: a segment between 2 points of the grid never goes out. */
+	class ShrunkWalls {
+	public:
+		explicit ShrunkWalls(const Grid& grid) :
+			columns(grid.x_size * FINE_CELLS),
+			rows(grid.z_size * FINE_CELLS),
+			solid_cells((size_t) columns * rows, 0)
+		{
+			const auto solid_or_outside = [&grid, this](const int32_t x, const int32_t z) {
+				return x < 0 || z < 0 || x >= columns || z >= rows ||
+					grid.wall_at((uint8_t) (x / FINE_CELLS), (uint8_t) (z / FINE_CELLS));
+			};
+
+			for (int32_t z = 0; z < rows; ++z)
+				for (int32_t x = 0; x < columns; ++x) {
+					bool surrounded = true;
+					for (int32_t dz = -1; dz <= 1 && surrounded; ++dz)
+						for (int32_t dx = -1; dx <= 1 && surrounded; ++dx)
+							surrounded = solid_or_outside(x + dx, z + dz);
+					solid_cells[(size_t) z * columns + x] = surrounded;
+				}
+		}
+
+		bool solid(const int32_t x, const int32_t z) const noexcept {
+			if (x < 0 || z < 0 || x >= columns || z >= rows)
+				return false;
+			return solid_cells[(size_t) z * columns + x] != 0;
+		}
+
+		int32_t clamp_column(const int32_t x) const noexcept {
+			return std::min(std::max(x, 0), columns - 1);
+		}
+
+		int32_t clamp_row(const int32_t z) const noexcept {
+			return std::min(std::max(z, 0), rows - 1);
+		}
+
+	private:
+		const int32_t columns;
+		const int32_t rows;
+		std::vector<uint8_t> solid_cells;
+	};
+
+	struct FinePoint {
+		float x;
+		float z;
+	};
+
+	/** Points on the sides of the cell that face the other cell: the corners and the middle of each side.
+	Any point on those sides is at most a fine cell away from one of them. In fine cell units. */
+	static std::vector<FinePoint> facing_points(const int32_t cell_x, const int32_t cell_z, const int32_t other_x, const int32_t other_z) {
+		const float left = (float) cell_x * FINE_CELLS;
+		const float bottom = (float) cell_z * FINE_CELLS;
+		constexpr float half = FINE_CELLS / 2;
+
+		std::vector<FinePoint> points;
+		if (other_x != cell_x) {
+			const float side_x = other_x > cell_x ? left + FINE_CELLS : left;
+			for (const float step : { 0.0f, half, 2 * half })
+				points.push_back({ side_x, bottom + step });
+		}
+		if (other_z != cell_z) {
+			const float side_z = other_z > cell_z ? bottom + FINE_CELLS : bottom;
+			for (const float step : { 0.0f, half, 2 * half })
+				points.push_back({ left + step, side_z });
+		}
+		return points;
+	}
+
+	static bool in_cell(const int32_t fine_x, const int32_t fine_z, const int32_t cell_x, const int32_t cell_z) noexcept {
+		return fine_x >= cell_x * FINE_CELLS && fine_x < (cell_x + 1) * FINE_CELLS
+			&& fine_z >= cell_z * FINE_CELLS && fine_z < (cell_z + 1) * FINE_CELLS;
+	}
+
+	/** Walks the fine cells crossed by the segment (Amanatides & Woo) and looks for a solid one.
+	The fine cells of the 2 grid cells at the ends are not checked: the segment starts and ends on their sides.
+	When the segment goes exactly across a corner it steps diagonally: the cells on the sides are only touched. */
+	static bool clear_line(const ShrunkWalls& walls, const FinePoint& from, const FinePoint& to,
+		const int32_t from_cell_x, const int32_t from_cell_z, const int32_t to_cell_x, const int32_t to_cell_z) noexcept
+	{
+		const float dx = to.x - from.x;
+		const float dz = to.z - from.z;
+
+		// Start and end a hair inside the segment, the end points on the borders would pick the cell on the wrong side.
+		// A segment along the far border of the grid walks the last fine cells.
+		constexpr float nudge = 1e-4f;
+		int32_t x = walls.clamp_column((int32_t) std::floor(from.x + dx * nudge));
+		int32_t z = walls.clamp_row((int32_t) std::floor(from.z + dz * nudge));
+		const int32_t end_x = walls.clamp_column((int32_t) std::floor(to.x - dx * nudge));
+		const int32_t end_z = walls.clamp_row((int32_t) std::floor(to.z - dz * nudge));
+
+		constexpr float never = std::numeric_limits<float>::max();
+		const int32_t step_x = dx > 0 ? 1 : -1;
+		const int32_t step_z = dz > 0 ? 1 : -1;
+		const float t_delta_x = dx != 0 ? std::abs(1 / dx) : never;
+		const float t_delta_z = dz != 0 ? std::abs(1 / dz) : never;
+		float t_max_x = dx > 0 ? (x + 1 - from.x) / dx : dx < 0 ? (x - from.x) / dx : never;
+		float t_max_z = dz > 0 ? (z + 1 - from.z) / dz : dz < 0 ? (z - from.z) / dz : never;
+
+		int32_t steps_left = std::abs(end_x - x) + std::abs(end_z - z);
+		while (true) {
+			const bool end_cell = in_cell(x, z, from_cell_x, from_cell_z) || in_cell(x, z, to_cell_x, to_cell_z);
+			if (!end_cell && walls.solid(x, z))
+				return false;
+
+			if ((x == end_x && z == end_z) || steps_left <= 0)
+				return true;
+
+			if (t_max_x < t_max_z) {
+				x += step_x;
+				t_max_x += t_delta_x;
+				--steps_left;
+			}
+			else if (t_max_z < t_max_x) {
+				z += step_z;
+				t_max_z += t_delta_z;
+				--steps_left;
+			}
+			else {
+				x += step_x;
+				z += step_z;
+				t_max_x += t_delta_x;
+				t_max_z += t_delta_z;
+				steps_left -= 2;
+			}
+		}
+	}
+
+	static bool cells_see_each_other(const ShrunkWalls& walls, const int32_t ax, const int32_t az, const int32_t bx, const int32_t bz) {
+		if (std::abs(ax - bx) <= 1 && std::abs(az - bz) <= 1)
+			return true;  // Touching, at least at the corners.
+
+		const std::vector<FinePoint> from_points = facing_points(ax, az, bx, bz);
+		const std::vector<FinePoint> to_points = facing_points(bx, bz, ax, az);
+
+		for (const FinePoint& from : from_points)
+			for (const FinePoint& to : to_points)
+				if (clear_line(walls, from, to, ax, az, bx, bz))
+					return true;
+
+		return false;
+	}
+
+
+	/** The cells that a sprite may cover: it turns to face the player, but it stays in the square around its
+	center. first > last when it is all outside the grid. */
+	struct CellRange {
+		int32_t first_x;
+		int32_t first_z;
+		int32_t last_x;
+		int32_t last_z;
+
+		bool outside() const noexcept { return first_x > last_x || first_z > last_z; }
+	};
+
+	static CellRange sprite_cells(const Grid& grid, const Sprite& sprite) noexcept {
+		const float half_size = (float) sprite.size / 2;
+		return CellRange{
+			std::max((int32_t) std::floor((sprite.x - half_size) / grid.cell_size), 0),
+			std::max((int32_t) std::floor((sprite.z - half_size) / grid.cell_size), 0),
+			std::min((int32_t) std::ceil((sprite.x + half_size) / grid.cell_size) - 1, grid.x_size - 1),
+			std::min((int32_t) std::ceil((sprite.z + half_size) / grid.cell_size) - 1, grid.z_size - 1)
+		};
+	}
+
+
+	PotentiallyVisibleSet::PotentiallyVisibleSet() :
+		x_size(0),
+		z_size(0),
+		cell_pairs(0)
+	{
+	}
+
+	PotentiallyVisibleSet::PotentiallyVisibleSet(const Grid& grid, const Objects& objects) :
+		x_size(grid.x_size),
+		z_size(grid.z_size),
+		cell_pairs(0)
+	{
+		if (objects.enemies.objects.size() > ObjectBits().size() || objects.exits.size() > ObjectBits().size())
+			throw std::runtime_error("Too many objects for the potentially visible set.");
+
+		// Only the cells with a piece of some object are ever looked at.
+		const size_t cells = (size_t) x_size * z_size;
+		std::vector<uint8_t> occupied(cells, 0);
+		const auto mark_occupied = [this, &grid, &occupied](const Sprite& sprite) {
+			const CellRange range = sprite_cells(grid, sprite);
+			for (int32_t z = range.first_z; z <= range.last_z; ++z)
+				for (int32_t x = range.first_x; x <= range.last_x; ++x)
+					occupied[(size_t) z * x_size + x] = 1;
+		};
+		for (const Sprite& enemy : objects.enemies.objects)
+			mark_occupied(enemy);
+		for (const Sprite& exit : objects.exits)
+			mark_occupied(exit);
+
+		std::vector<size_t> occupied_cells;
+		size_t empty_cells = 0;
+		for (size_t cell = 0; cell < cells; ++cell) {
+			if (occupied[cell])
+				occupied_cells.push_back(cell);
+			if (!grid.wall_at((uint8_t) (cell % x_size), (uint8_t) (cell / x_size)))
+				++empty_cells;
+		}
+
+		cell_pairs = (uint64_t) empty_cells * occupied_cells.size();
+		if (build_work() > MAX_BUILD_WORK)
+			return;  // Stays empty, see report.
+
+		const ShrunkWalls walls(grid);
+		visible_objects.assign(cells, VisibleObjects::all());  // The player should never be in a wall. If it is, nothing is hidden.
+		std::vector<uint8_t> seen(cells, 0);  // From the current cell, only the occupied ones are set.
+
+		for (size_t from = 0; from < cells; ++from) {
+			const int32_t from_x = (int32_t) (from % x_size);
+			const int32_t from_z = (int32_t) (from / x_size);
+			if (grid.wall_at((uint8_t) from_x, (uint8_t) from_z))
+				continue;
+
+			for (const size_t to : occupied_cells)
+				seen[to] = cells_see_each_other(walls, from_x, from_z, (int32_t) (to % x_size), (int32_t) (to / x_size));
+
+			VisibleObjects& visible = visible_objects[from];
+			visible = VisibleObjects{};
+			for (size_t i = 0; i < objects.enemies.objects.size(); ++i)
+				visible.enemies[i] = sprite_visible(grid, seen, objects.enemies.objects[i]);
+			for (size_t i = 0; i < objects.exits.size(); ++i)
+				visible.exits[i] = sprite_visible(grid, seen, objects.exits[i]);
+		}
+	}
+
+	const VisibleObjects& PotentiallyVisibleSet::objects_visible_from(const GridCoordinate& from) const noexcept
+	{
+		if (empty() || !inside(from))
+			return VisibleObjects::all();
+
+		return visible_objects[cell_index(from)];
+	}
+
+	bool PotentiallyVisibleSet::empty() const noexcept
+	{
+		return visible_objects.empty();
+	}
+
+	std::string PotentiallyVisibleSet::report() const
+	{
+		std::ostringstream report;
+		if (!empty())
+			report << "Potentially visible set: " << cell_pairs << " cell pairs tested.";
+		else if (build_work() > MAX_BUILD_WORK)
+			report << "Potentially visible set skipped: " << cell_pairs << " cell pairs to test, work " << build_work()
+				<< ", more than " << MAX_BUILD_WORK << ". Nothing is culled.";
+		else
+			report << "No potentially visible set. Nothing is culled.";
+		return report.str();
+	}
+
+	uint64_t PotentiallyVisibleSet::build_work() const noexcept
+	{
+		return cell_pairs * ((uint64_t) x_size + z_size);
+	}
+
+	size_t PotentiallyVisibleSet::cell_index(const GridCoordinate& cell) const noexcept
+	{
+		return (size_t) cell.z * x_size + cell.x;
+	}
+
+	bool PotentiallyVisibleSet::inside(const GridCoordinate& cell) const noexcept
+	{
+		return !cell.outside_world() && cell.x < x_size && cell.z < z_size;
+	}
+
+	bool PotentiallyVisibleSet::sprite_visible(const Grid& grid, const std::vector<uint8_t>& seen, const Sprite& sprite) const noexcept
+	{
+		const CellRange range = sprite_cells(grid, sprite);
+		if (range.outside())
+			return true;  // No idea.
+
+		for (int32_t z = range.first_z; z <= range.last_z; ++z)
+			for (int32_t x = range.first_x; x <= range.last_x; ++x)
+				if (seen[(size_t) z * x_size + x])
+					return true;
+
+		return false;
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Grid.h"
+#include "Objects.h"
+
+namespace rc {
+
+	/** What can possibly be seen from each cell of the grid, computed once when the level is loaded.
+	The walls and the sprites never move, so this never changes during the game.
+
+	For each cell there are the bits of the enemies and exits that may be seen from there. The renderer and the
+	hit-scan skip everything else without even looking at it: in a maze of rooms, the enemies behind the walls
+	cost nothing.
+
+	It is conservative: something may be marked visible and never be seen, but nothing that can be seen is
+	ever left out. The player can be anywhere in the cell, the sprite anywhere in its cells. A line of sight
+	from a cell to another leaves the first through the sides that face the other and enters the other the same
+	way. Only few points are tried on those sides, so the lines tried are off by up to a quarter of cell from
+	the real ones. To make up for it, the lines are tested against walls shrunk by a quarter of cell where
+	they face empty space: if the real line is clear, the closest line tried does not touch the shrunk walls.
+
+	Only the cells where there are objects are tested, from every empty cell: the time is proportional to their
+	product (the cell pairs) times the length of the lines. A 64x64 maze with a few dozens enemies takes a fraction
+	of second. Above MAX_BUILD_WORK the set is not built, it stays empty (nothing is culled) and the report says so.
+	*/
+	class PotentiallyVisibleSet {
+	public:
+		/** Empty: everything is visible from everywhere. */
+		PotentiallyVisibleSet();
+
+		/** Throws if there are more objects than the bits of VisibleObjects. */
+		PotentiallyVisibleSet(const Grid& grid, const Objects& objects);
+
+		/** Any cell outside the grid (or an empty set) sees everything. */
+		const VisibleObjects& objects_visible_from(const GridCoordinate& from) const noexcept;
+
+		bool empty() const noexcept;
+
+		/** Built or not, and why. For the console at load time, like Objects::broad_phase_report. */
+		std::string report() const;
+
+		/** Cell pairs times the width plus the depth of the grid: a bound of the cells that their lines cross.
+		About half a second of loading on an open 255x255 grid, less on mazes where most lines stop early. */
+		static constexpr uint64_t MAX_BUILD_WORK = 1 << 26;
+
+	private:
+		uint8_t x_size;
+		uint8_t z_size;
+		uint64_t cell_pairs;  /// Empty cells times the cells with objects: the work to build the set.
+
+		/** One for each cell. Cell index is z * x_size + x. */
+		std::vector<VisibleObjects> visible_objects;
+
+		uint64_t build_work() const noexcept;
+		size_t cell_index(const GridCoordinate& cell) const noexcept;
+		bool inside(const GridCoordinate& cell) const noexcept;
+
+		/** If any of the cells of the sprite is seen. */
+		bool sprite_visible(const Grid& grid, const std::vector<uint8_t>& seen, const Sprite& sprite) const noexcept;
+	};
+}
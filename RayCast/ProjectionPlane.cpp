@@ -1,9 +1,14 @@
 #include "pch.h"
 #include "ProjectionPlane.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
 
 #include "PI.h"
+#include "Shading.h"
 #include "Sprite.h"
 
 #include <iostream>
@@ -11,59 +16,407 @@
 namespace rc {
 
 	ProjectionPlane::ProjectionPlane(uint16_t h_resolution, uint16_t v_resolution, float FOV_degrees) :
+		ProjectionPlane(h_resolution, v_resolution, FOV_degrees, h_resolution)
+	{
+	}
+
+	ProjectionPlane::ProjectionPlane(uint16_t h_resolution, uint16_t v_resolution, float FOV_degrees, uint16_t display_width) :
+		ProjectionPlane(h_resolution, v_resolution, pov_distance(display_width, FOV_degrees), to_radians(FOV_degrees / h_resolution),
+			compute_column_angles(h_resolution, to_radians(FOV_degrees / h_resolution)))
+	{
+	}
+
+	ProjectionPlane::ProjectionPlane(uint16_t h_resolution, uint16_t v_resolution, uint32_t distance_to_POV, float scan_step_radians,
+		std::vector<float> column_angles) :
 		columns(h_resolution),
+		rows(v_resolution),
 		x_center(h_resolution / 2),
 		y_center(v_resolution / 2),
-		distance_to_POV(pov_distance(h_resolution, FOV_degrees)),
-		scan_step_radians(to_radians(FOV_degrees / h_resolution))
+		distance_to_POV(distance_to_POV),
+		scan_step_radians(scan_step_radians),
+		column_angles(std::move(column_angles)),
+		column_directions(this->column_angles.begin(), this->column_angles.end()),
+		sprite_order(SpriteOrder::BACK_TO_FRONT),
+		wall_drawing(WallDrawing::SLICES),
+		wall_sampling(WallSampling::EVERY_COLUMN),
+		sample_spacing(8),
+		view_distance(Grid::UNLIMITED),
+		fog(false),
+		wall_searches(0),
+		depth_buffer(h_resolution),
+		wall_hits(h_resolution),
+		wall_columns(h_resolution),
+		coverage(h_resolution, v_resolution)
+	{
+	}
+
+	SliceProjection ProjectionPlane::project_slice(const float hit_distance, const uint16_t object_size) const
 	{
+		return project_slice_rows(hit_distance, object_size, 0, object_size);
 	}
 
-	SliceProjection ProjectionPlane::project_slice(const float hit_distance, const uint16_t cell_size) const
+	/** The screen row y shows the texel (y - full top) * step. The run covers the rows where this falls
+	between the first and the end texel, then the result is clipped to the screen like the whole slice. */
+	SliceProjection ProjectionPlane::project_slice_rows(const float hit_distance, const uint16_t object_size,
+		const uint16_t first_texel_row, const uint16_t end_texel_row) const
 	{
+		// Work on wide integers, the unclipped slice can be huge when the hit is very close.
+		// Clamping the float avoids the overflow in the conversion when the distance is (almost) 0.
+		constexpr float max_projected_height = 1e9f;
+		const float projected_height = std::min(object_size / hit_distance * distance_to_POV, max_projected_height);
+		const int32_t full_height = (int32_t) projected_height;
+		const int32_t full_top_row = y_center - full_height / 2;
+
+		const float rows_per_texel = (float) full_height / std::max(object_size, (uint16_t) 1);
+		const int32_t run_top_row = full_top_row + (int32_t) std::ceil(first_texel_row * rows_per_texel);
+		const int32_t run_bottom_row = full_top_row + (int32_t) std::ceil(end_texel_row * rows_per_texel);
+
+		const int32_t visible_top_row = std::max(run_top_row, 0);
+		const int32_t visible_bottom_row = std::min(run_bottom_row, (int32_t) rows);
+
 		SliceProjection projected_slice;
-		projected_slice.height = (uint16_t) (cell_size / hit_distance * distance_to_POV);
-		projected_slice.top_row = y_center - projected_slice.height / 2;
+		projected_slice.top_row = (uint16_t) std::min(visible_top_row, (int32_t) rows);
+		projected_slice.height = (uint16_t) std::max(visible_bottom_row - visible_top_row, 0);
+		projected_slice.texture_step = (float) object_size / std::max(full_height, 1);
+		projected_slice.texture_top = (visible_top_row - full_top_row) * projected_slice.texture_step;
+		projected_slice.light_level = shade(hit_distance);
 
 		return projected_slice;
 	}
 
-	void ProjectionPlane::project_objects(const World& world, Canvas& c) const
+	void ProjectionPlane::project_objects(const World& world, Canvas& c)
 	{
-		const Grid& grid = world.map;
-		const Player& player = world.player;
+		project_objects<Canvas>(world, c);
+	}
 
-		const float original_ray_orientation = player.orientation;
+	void ProjectionPlane::prepare(const World& world, const Camera& camera)
+	{
+		const Grid& grid = world.map;
+		slice_draws.clear();
+		span_draws.clear();
 
-		Ray r{player.x_position, player.z_position, player.orientation};
-		r.alpha_rad -= columns / 2 * scan_step_radians; // "Go left" to the beginning.
+		cast_walls(grid, camera);
+		correct_fishbowl();
 		
-		for (uint16_t scan_column = 0; scan_column < columns; ++scan_column) {
-			r.alpha_rad = normalize_0_2pi(r.alpha_rad);
+		project_walls(grid);
 
-			const float fishbowl = std::cos(original_ray_orientation - r.alpha_rad);
+		if (wall_drawing == WallDrawing::SPANS)
+			project_wall_spans(grid.cell_size);
 
-			RayHit wall_hit = grid.cast_ray(r);
-			if (wall_hit.really_hit()) {
-				wall_hit.distance *= fishbowl;
-				
+		project_sprites(world, camera);
+	}
+
+	void ProjectionPlane::project_walls(const Grid& grid)
+	{
+		for (uint16_t scan_column = 0; scan_column < columns; ++scan_column)
+			project_wall_column(grid, scan_column);
+	}
+
+	void ProjectionPlane::project_wall_column(const Grid& grid, const uint16_t scan_column)
+	{
+		RayHit wall_hit = wall_hits[scan_column];
+		if (wall_hit.really_hit()) {
+			wall_hit.distance = depth_buffer[scan_column];
+
+			if (wall_drawing == WallDrawing::SLICES) {
 				const SliceProjection wall_projection = project_slice(wall_hit.distance, grid.cell_size);
-				c.draw_slice(scan_column, wall_projection.top_row, wall_projection.height, wall_hit.offset, TextureIndex::WALL);
+				slice_draws.push_back(SliceDraw{ scan_column, wall_projection, wall_hit.offset, TextureIndex::WALL });
+			}
+			else {
+				// Same height of project_slice, the offset without truncation.
+				WallColumn& wall = wall_columns[scan_column];
+				wall.height = std::min(grid.cell_size / wall_hit.distance * distance_to_POV, 1e9f);
+				const bool along_x = wall_hit.face == WallFace::BOTTOM || wall_hit.face == WallFace::TOP;
+				wall.offset = along_x ?
+					wall_hit.x - wall_hit.cell_x * grid.cell_size :
+					wall_hit.z - wall_hit.cell_z * grid.cell_size;
+				wall.cell_x = wall_hit.cell_x;
+				wall.cell_z = wall_hit.cell_z;
+				wall.face = wall_hit.face;
+				wall.light_level = shade(wall_hit.distance);
+			}
+		}
+		else {
+			wall_columns[scan_column].face = WallFace::NONE;
+		}
+	}
+
+	void ProjectionPlane::correct_fishbowl()
+	{
+		for (uint16_t scan_column = 0; scan_column < columns; ++scan_column) {
+			const RayHit& wall_hit = wall_hits[scan_column];
+			depth_buffer[scan_column] = wall_hit.really_hit() ?
+				wall_hit.distance * column_directions[scan_column].cos() :
+				std::numeric_limits<float>::max();  // Nothing hides the sprites.
+		}
+	}
+
+	void ProjectionPlane::cast_walls(const Grid& grid, const Camera& camera)
+	{
+		wall_searches = 0;
+
+		if (wall_sampling == WallSampling::EVERY_COLUMN || sample_spacing < 2) {
+			for (uint16_t scan_column = 0; scan_column < columns; ++scan_column)
+				wall_hits[scan_column] = search_wall(grid, camera, scan_column);
+			return;
+		}
+
+		uint16_t previous_sample = 0;
+		wall_hits[previous_sample] = search_wall(grid, camera, previous_sample);
+
+		while (previous_sample + 1 < columns) {
+			const uint16_t next_sample = (uint16_t) std::min(previous_sample + sample_spacing, columns - 1);
+			wall_hits[next_sample] = search_wall(grid, camera, next_sample);
+			fill_between_samples(grid, camera, previous_sample, next_sample);
+			previous_sample = next_sample;
+		}
+	}
+
+	/** If the rays of the 2 columns hit the same face of the same cell, the hits are less than a cell apart.
+	A wall cell that stops the rays in between would have to fit in the triangle between the camera and
+	the 2 hits, and it is too big for that. */
+	void ProjectionPlane::fill_between_samples(const Grid& grid, const Camera& camera, const uint16_t first_column, const uint16_t last_column)
+	{
+		if (last_column - first_column < 2)
+			return;  // Nothing in between.
+
+		const RayHit& first = wall_hits[first_column];
+		const RayHit& last = wall_hits[last_column];
+		const bool same_face = first.really_hit() && last.really_hit()
+			&& first.face == last.face && first.cell_x == last.cell_x && first.cell_z == last.cell_z;
+
+		if (same_face) {
+			for (uint16_t scan_column = first_column + 1; scan_column < last_column; ++scan_column)
+				wall_hits[scan_column] = grid.cast_ray_on_face(column_ray(camera, scan_column), first.cell_x, first.cell_z, first.face);
+			return;
+		}
+
+		// An edge or a corner (or nothing at all) in between: look closer.
+		const uint16_t middle_column = first_column + (last_column - first_column) / 2;
+		wall_hits[middle_column] = search_wall(grid, camera, middle_column);
+		fill_between_samples(grid, camera, first_column, middle_column);
+		fill_between_samples(grid, camera, middle_column, last_column);
+	}
+
+	RayHit ProjectionPlane::search_wall(const Grid& grid, const Camera& camera, const uint16_t column)
+	{
+		++wall_searches;
+		return grid.cast_ray(column_ray(camera, column), view_distance);
+	}
+
+	Ray ProjectionPlane::column_ray(const Camera& camera, const uint16_t column) const
+	{
+		return Ray{ camera.x, camera.z, camera.orientation + column_directions[column] };
+	}
+
+	/** Groups the consecutive columns that see the same face of the same cell, at the same light level. */
+	void ProjectionPlane::project_wall_spans(const uint8_t cell_size)
+	{
+		uint16_t first_column = 0;
+		while (first_column < columns) {
+			const WallColumn& first = wall_columns[first_column];
+			uint16_t last_column = first_column;
+
+			while (last_column + 1 < columns) {
+				const WallColumn& next = wall_columns[last_column + 1];
+				if (next.face != first.face || next.cell_x != first.cell_x || next.cell_z != first.cell_z || next.light_level != first.light_level)
+					break;
+				++last_column;
+			}
+
+			if (first.face != WallFace::NONE)
+				project_wall_run(first_column, last_column, cell_size);
+
+			first_column = last_column + 1;
+		}
+	}
+
+	/** The interpolation of the span is exact only on a flat projection plane. The columns are spaced by angle,
+	so check it against what the rays found: if it is off by half a pixel or half a texel somewhere, split the run
+	where it is worst and try again with the two halves. */
+	void ProjectionPlane::project_wall_run(const uint16_t first_column, const uint16_t last_column, const uint8_t cell_size)
+	{
+		const WallColumn& first = wall_columns[first_column];
+		const WallColumn& last = wall_columns[last_column];
+
+		WallSpan span;
+		span.first_column = first_column;
+		span.last_column = last_column;
+		span.first_height = first.height;
+		span.last_height = last.height;
+		span.first_offset = first.offset;
+		span.last_offset = last.offset;
+		span.object_size = cell_size;
+		span.light_level = first.light_level;
+
+		constexpr float tolerance = 0.5f;
+		float worst_error = tolerance;
+		uint16_t worst_column = first_column;
+
+		for (uint16_t column = first_column + 1; column < last_column; ++column) {
+			const WallColumn& wall = wall_columns[column];
+			const float error = std::max(
+				std::abs(span.height_at(column) - wall.height),
+				std::abs(span.offset_at(column) - wall.offset));
+
+			if (error > worst_error) {
+				worst_error = error;
+				worst_column = column;
+			}
+		}
+
+		if (worst_column == first_column) {
+			span_draws.push_back(span);
+			return;
+		}
+
+		project_wall_run(first_column, worst_column, cell_size);
+		project_wall_run(worst_column + 1, last_column, cell_size);
+	}
+
+	/** The sprites are billboards: they always face the player, and they are hit by the ray of a column
+	if the sprite center is close enough to that ray (read Sprite::intersection to see the geometry).
+	
+	Call gamma the angle between the column ray and the direction of the sprite center. The ray hits the billboard
+	at distance * tan(gamma) from the sprite center, as long as this is less than half the sprite size.
+	The sprite covers all the columns at most atan(half size / distance) away from its center.
+	Those columns are computed once per sprite. Columns are evenly spaced by angle, not on a flat projection plane,
+	therefore the column is found from the angle and not from the usual perspective division.
+	*/
+	void ProjectionPlane::project_sprites(const World& world, const Camera& camera)
+	{
+		const float cos_orientation = camera.orientation.cos();
+		const float sin_orientation = camera.orientation.sin();
+
+		visible_sprites.clear();
+		// The sprites that can not be seen from the camera cell are skipped before any math.
+		const VisibleObjects& potentially_visible = world.visibility.objects_visible_from(world.map.cell_of(camera.x, camera.z));
+		cull_sprites(world.sprites.enemies.objects, potentially_visible.enemies, camera, cos_orientation, sin_orientation);
+		cull_sprites(world.sprites.exits, potentially_visible.exits, camera, cos_orientation, sin_orientation);
+
+		if (sprite_order == SpriteOrder::BACK_TO_FRONT) {
+			// Painter's algorithm: the farthest first, so that the closest is drawn on top of them.
+			std::sort(visible_sprites.begin(), visible_sprites.end(),
+				[](const VisibleSprite& s1, const VisibleSprite& s2) {
+					return s2.distance < s1.distance;
+				}
+			);
+		}
+		else {
+			std::sort(visible_sprites.begin(), visible_sprites.end(),
+				[](const VisibleSprite& s1, const VisibleSprite& s2) {
+					return s1.distance < s2.distance;
+				}
+			);
+			coverage.clear();
+		}
+
+		for (const VisibleSprite& visible : visible_sprites) {
+			const float half_size = (float) visible.sprite->size / 2;
+			const BinaryAngle sprite_direction(visible.angle);
+			const AlphaMask& mask = world.masks.of(visible.sprite->kind);
+
+			for (uint16_t scan_column = visible.first_column; scan_column <= visible.last_column; ++scan_column) {
+				if (sprite_order == SpriteOrder::FRONT_TO_BACK && coverage.full(scan_column))
+					continue;  // Closer sprites hide everything already.
+
+				const BinaryAngle gamma = column_directions[scan_column] - sprite_direction;
+				const float distance_from_center = visible.distance * gamma.tan();
+				if (std::abs(distance_from_center) > half_size)
+					continue;
+
+				// Distance to the billboard along the ray, then the same correction of the walls.
+				const float hit_distance = visible.distance / gamma.cos() * column_directions[scan_column].cos();
+				if (hit_distance >= depth_buffer[scan_column])
+					continue;  // Behind the wall.
+
+				const uint16_t texture_offset = (uint16_t) std::min(distance_from_center + half_size, (float) visible.sprite->size - 1);
+
+				// No runs at all for the fully transparent columns, nothing to draw.
+				for (const AlphaMask::VisibleRun& run : mask.visible_runs(texture_offset)) {
+					const uint16_t end_row = std::min(run.end_row, (uint16_t) visible.sprite->size);
+					const SliceProjection run_projection = project_slice_rows(hit_distance, visible.sprite->size, run.first_row, end_row);
+					if (run_projection.height > 0)
+						draw_sprite_slice(scan_column, run_projection, texture_offset, visible.sprite->kind);
+				}
 			}
+		}
+	}
 
-			const std::vector<RayHit> object_hits = world.sprites.all_intersections(r, wall_hit, (uint8_t)TextureIndex::ENEMY | (uint8_t)TextureIndex::EXIT);
-			for (const RayHit& enemy_hit : object_hits)
-			{
-				const float corrected_distance = enemy_hit.distance * fishbowl;
+	/** Front to back, the slice is cut around the rows that the closer sprites already covered.
+	The pieces keep the texture coordinates of the rows where they start. */
+	void ProjectionPlane::draw_sprite_slice(const uint16_t column, const SliceProjection& slice, const uint16_t texture_offset, const TextureIndex kind)
+	{
+		if (sprite_order == SpriteOrder::BACK_TO_FRONT) {
+			slice_draws.push_back(SliceDraw{ column, slice, texture_offset, kind });
+			return;
+		}
 
-				const SliceProjection enemy_projection = project_slice(corrected_distance, 64); // Size of the sprite! TODO: avoid hardcode.
-				c.draw_slice(scan_column, enemy_projection.top_row, enemy_projection.height, enemy_hit.offset, enemy_hit.type);
+		const uint16_t bottom_row = slice.top_row + slice.height;
+		coverage.for_each_free_span(column, slice.top_row, bottom_row,
+			[&](const ColumnCoverage::RowSpan& free_rows) {
+				SliceProjection piece = slice;
+				piece.top_row = free_rows.top;
+				piece.height = free_rows.bottom - free_rows.top;
+				piece.texture_top = slice.texture_top + (free_rows.top - slice.top_row) * slice.texture_step;
+				slice_draws.push_back(SliceDraw{ column, piece, texture_offset, kind });
 			}
+		);
+		coverage.cover(column, slice.top_row, bottom_row);
+	}
+
+	void ProjectionPlane::cull_sprites(const std::vector<Sprite>& sprites, const ObjectBits& potentially_visible,
+		const Camera& camera, const float cos_orientation, const float sin_orientation)
+	{
+		const float leftmost_angle = column_angles.front();
+		const float rightmost_angle = column_angles.back();
+
+		for (size_t sprite_index = 0; sprite_index < sprites.size(); ++sprite_index) {
+			const Sprite& sprite = sprites[sprite_index];
+			if (!sprite.active || (sprite_index < potentially_visible.size() && !potentially_visible[sprite_index]))
+				continue;
 
-			r.alpha_rad += scan_step_radians;
+			// Camera coordinates: depth along the camera orientation, side along the perpendicular
+			// (positive towards growing angles, like the columns).
+			const float world_x = sprite.x - camera.x;
+			const float world_z = sprite.z - camera.z;
+			const float depth = world_x * cos_orientation + world_z * sin_orientation;
+			const float side = world_z * cos_orientation - world_x * sin_orientation;
+
+			const float half_size = (float) sprite.size / 2;
+			if (depth <= 0)
+				continue;  // Behind the camera (or so close that the projection makes no sense).
+
+			const float distance = std::sqrt(depth * depth + side * side);
+			if (distance - half_size > view_distance)
+				continue;  // Too far to be seen.
+
+			const float angle = std::atan2(side, depth);
+			const float half_angular_size = std::atan(half_size / distance);
+
+			if (angle + half_angular_size < leftmost_angle || angle - half_angular_size > rightmost_angle)
+				continue;  // Outside the field of view.
+
+			const float first_column = std::ceil((angle - half_angular_size - leftmost_angle) / scan_step_radians);
+			const float last_column = std::floor((angle + half_angular_size - leftmost_angle) / scan_step_radians);
+
+			VisibleSprite visible;
+			visible.sprite = &sprite;
+			visible.distance = distance;
+			visible.angle = angle;
+			visible.first_column = (uint16_t) std::max(first_column, 0.0f);
+			visible.last_column = (uint16_t) std::min(last_column, (float) columns - 1);
+
+			if (visible.first_column <= visible.last_column)
+				visible_sprites.push_back(visible);
 		}
 	}
 
+	uint8_t ProjectionPlane::shade(const float distance) const noexcept
+	{
+		return fog ? fog_light_level(distance, view_distance) : light_level(distance);
+	}
+
 	/** Consider a triangle with a vertex in the center of the plane, one in the Point of View, the last
 		on the vertical border of the plane. Then do trig. Seen from above, it is:
 
@@ -76,26 +429,34 @@ namespace rc {
 		   Point of view
 		   (Angle here is half the FOV).
 		*/
-	uint16_t ProjectionPlane::pov_distance(uint16_t h_resolution, float FOV_degrees) const
+	uint32_t ProjectionPlane::pov_distance(uint16_t h_resolution, float FOV_degrees)
 	{
+		if (!(FOV_degrees > 0 && FOV_degrees < 180))
+			throw std::runtime_error("The field of view must be more than 0 and less than 180 degrees.");
+
 		const float FOV_radians = to_radians(FOV_degrees);
-		const float distance = (h_resolution / 2) / (std::tan(FOV_radians / 2));
+		const float distance = (h_resolution / 2.0f) / (std::tan(FOV_radians / 2));
 
-		return (uint16_t)std::floor(distance);
+		return (uint32_t)std::floor(distance);
 	}
 
 
-	float ProjectionPlane::to_radians(const float degrees) const
+	/** The same angles that the original scan got by adding the step to the ray, one column at a time.
+	The first column is at half the FOV on the "negative" side of the orientation. */
+	std::vector<float> ProjectionPlane::compute_column_angles(const uint16_t columns, const float scan_step_radians)
 	{
-		return normalize_0_2pi(degrees * (float)PI / 180);
+		std::vector<float> angles(columns);
+		for (uint16_t scan_column = 0; scan_column < columns; ++scan_column)
+			angles[scan_column] = ((int32_t) scan_column - columns / 2) * scan_step_radians;
+
+		return angles;
 	}
 
-	float ProjectionPlane::normalize_0_2pi(float radians) const
+	/** The FOV and the scan step are less than a full turn, no need to normalize them.
+	The ray angles are binary angles, that wrap around by themselves. */
+	float ProjectionPlane::to_radians(const float degrees)
 	{
-		while (radians < 0) // TODO: there's got to be a formula... Also, adding 4PI at a time (to do half the loops) causes distortions.
-			radians += 2 * PI;
-
-		return radians - std::floor(radians / (2 * PI)) * radians;
+		return degrees * (float)PI / 180;
 	}
 
 }
\ No newline at end of file
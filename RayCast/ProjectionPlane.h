@@ -1,21 +1,19 @@
 #pragma once
 
 #include <cstdint>
+#include <vector>
 
+#include "BinaryAngle.h"
+#include "Camera.h"
 #include "World.h"
 #include "Canvas.h"
+#include "ColumnCoverage.h"
+#include "Sprite.h"
 
 
 
 namespace rc {
 
-	/** Results of projecting a piece of some object. */
-	struct SliceProjection{
-		uint16_t height;  
-		int16_t top_row; /// Can be negative if you are really close to the wall and the slice it taller than the screen.
-	};
-
-
 	/** The ProjectionPlane class computes the simplified projection, after the ray casting. 
 	    Assumed to have the same resolution as the window on the screen. I did not want to deal with
 		viewport scaling.
@@ -27,11 +25,56 @@ namespace rc {
 	class ProjectionPlane
 	{
 	public:
+		/** How the sprites are layered on each other.
+		
+		BACK_TO_FRONT is the painter's algorithm: everything is drawn, the closest sprites are drawn last.
+		FRONT_TO_BACK draws the closest first and never draws again over its pixels (see ColumnCoverage):
+		less pixels written in crowds, but the semi-transparent borders do not blend with the sprites behind. */
+		enum class SpriteOrder {
+			BACK_TO_FRONT,
+			FRONT_TO_BACK
+		};
+
+		/** How the walls are sent to the canvas.
+
+		SLICES calls draw_slice once per column. SPANS merges the consecutive columns that see the same face
+		of the same cell in a single draw_span call (see WallSpan): tens of times less calls when the walls
+		fill the view. */
+		enum class WallDrawing {
+			SLICES,
+			SPANS
+		};
+
+		/** Which columns cast a ray in the grid to find the walls.
+
+		EVERY_COLUMN is the plain scan. ADAPTIVE casts a ray every sample_spacing columns. When two samples hit
+		the same face of the same cell, nothing can be in between (a wall cell does not fit between the rays),
+		so the columns in between are computed directly on that face. Otherwise the middle column is cast and
+		the two halves are checked again. The walls come out exactly the same. */
+		enum class WallSampling {
+			EVERY_COLUMN,
+			ADAPTIVE
+		};
+
 		ProjectionPlane(uint16_t h_resolution, uint16_t v_resolution, float FOV_degrees);
 
+		/** A plane with fewer columns than the screen, whose picture is stretched to display_width pixels
+		(see ResolutionGovernor). The rows are not stretched, so the heights are computed as if the plane
+		had display_width columns: the walls do not change size with the resolution. */
+		ProjectionPlane(uint16_t h_resolution, uint16_t v_resolution, float FOV_degrees, uint16_t display_width);
+
+		virtual ~ProjectionPlane() = default;
+
 		/** "Semi-private" function. It is not used outside the class, but I felt I had to test it 
-		to ensure correctness. */
-		SliceProjection project_slice(const float hit_distance, const uint16_t cell_size) const;
+		to ensure correctness.
+		
+		Clips the slice to the screen rows and finds the part of the texture that remains visible. */
+		SliceProjection project_slice(const float hit_distance, const uint16_t object_size) const;
+
+		/** Same as project_slice, but only for the texture rows from first_texel_row up to end_texel_row (excluded).
+		Used to draw just the visible runs of the sprites. The rows must be in [0, object_size]. */
+		SliceProjection project_slice_rows(const float hit_distance, const uint16_t object_size,
+			const uint16_t first_texel_row, const uint16_t end_texel_row) const;
 
 		/** Entry point of the exercise. Does the ray casting scan.
 		
@@ -39,20 +82,172 @@ namespace rc {
 		If it hits a wall, project the vertical wall slice in the canvas.
 
 		It's harder than this. Consult the project reference material.
+
+		The sprites are not ray cast. The wall pass remembers the distance of the wall in each column (depth buffer),
+		then each sprite is projected once and drawn only in the columns where it is in front of the wall.
+		Only the visible runs of the sprite texture are drawn (see AlphaMask): they skip just the fully transparent
+		pixels, that would not change the image anyway. The soft edges are still drawn and blended.
 		*/
-		void project_objects(const World& grid, Canvas &c) const;
+		void project_objects(const World& grid, Canvas &c);
+
+		/** The same, for any class with the draw_slice and draw_span of Canvas (it does not have to derive from it).
+		
+		With the real type of the canvas, the calls are direct (and can be inlined if the canvas methods are visible,
+		or if the class is final): no virtual call for each column. The projection first computes all the slices and
+		spans of the frame, then a tight loop hands them to the canvas in the very same order. The version above is
+		the adapter for whoever only has a Canvas. */
+		template <typename CANVAS>
+		void project_objects(const World& world, CANVAS& c);
+
+		/** The world seen from any camera, not only from the player. */
+		template <typename CANVAS>
+		void project_objects(const World& world, const Camera& camera, CANVAS& c);
+
+		/** project_objects in two steps. prepare does all the work, but the canvas calls: it can run on any thread,
+		at the same time as the other planes (it only reads the world). draw hands the results to the canvas.
+		Everything the plane prepared stays there until the next prepare. */
+		void prepare(const World& world, const Camera& camera);
+
+		template <typename CANVAS>
+		void draw(CANVAS& c) const;
 
 		// Some of those are public for testing purposes.
 		const uint16_t columns;
+		const uint16_t rows;
 		const uint16_t x_center;
 		const uint16_t y_center;
-		const uint16_t distance_to_POV;
+		/** 32 bits: on a wide screen with a narrow FOV the plane is further than 65535 pixels. */
+		const uint32_t distance_to_POV;
 		const float scan_step_radians;
 
+		/** Angle between the ray of each column and the player orientation. */
+		const std::vector<float> column_angles;
+		/** The same, as binary angles: added to the player orientation they give the ray of the column. */
+		const std::vector<BinaryAngle> column_directions;
+
+		/** Can be changed between frames. Back to front by default. */
+		SpriteOrder sprite_order;
+
+		/** Can be changed between frames. Slices by default. */
+		WallDrawing wall_drawing;
+
+		/** Can be changed between frames. Every column by default. */
+		WallSampling wall_sampling;
+		uint16_t sample_spacing;
+
+		/** Can be changed between frames. Nothing further than this is drawn: the rays stop looking for walls
+		and the sprites are culled. It bounds the cost of a column on big open maps. Unlimited by default. */
+		float view_distance;
+
+		/** Fade to the darkest light level at the view distance, so that things do not pop in. Off by default. */
+		bool fog;
+
+		/** Rays that searched the grid for walls in the last frame. Only for statistics. */
+		uint32_t wall_searches;
+
+	protected:
+		/** For the planes that computed their tables already (see FixedProjectionPlane). */
+		ProjectionPlane(uint16_t h_resolution, uint16_t v_resolution, uint32_t distance_to_POV, float scan_step_radians,
+			std::vector<float> column_angles);
+
+		/** Fills the depth buffer with the distance of the wall hits, corrected by the cosine of the column angle. */
+		virtual void correct_fishbowl();
+
+		/** After the fishbowl pass: the wall of each column, as a slice to draw or as a column to merge in the spans. */
+		virtual void project_walls(const Grid& grid);
+
+		/** The wall of a column, at the distance in the depth buffer. */
+		void project_wall_column(const Grid& grid, const uint16_t scan_column);
+
+		/** Distance of the wall seen in each column (fishbowl corrected), filled by the wall pass. */
+		std::vector<float> depth_buffer;
+
+		/** What the rays found, before the fishbowl correction. */
+		std::vector<RayHit> wall_hits;
+
 	private:
-		uint16_t pov_distance(uint16_t h_resolution, float FOV_degrees) const;
-		float to_radians(const float degrees) const;
-		float normalize_0_2pi(float radians) const;
+		/** A sprite that survived the frustum culling, in "camera coordinates". */
+		struct VisibleSprite {
+			const Sprite* sprite;
+			float distance;  /// From the player to the sprite center.
+			float angle;  /// Between the player orientation and the sprite center.
+			uint16_t first_column;
+			uint16_t last_column;
+		};
+
+		/** What the ray of a column found, to merge the spans after the wall pass. */
+		struct WallColumn {
+			float height;  /// Projected, not clipped.
+			float offset;  /// Texture column, with the fraction.
+			uint8_t cell_x;
+			uint8_t cell_z;
+			WallFace face;  /// NONE if there is no wall.
+			uint8_t light_level;
+		};
+
+		/** Only for the SPANS drawing. */
+		std::vector<WallColumn> wall_columns;
+
+		/** Kept between frames only to avoid allocating it every time. */
+		std::vector<VisibleSprite> visible_sprites;
+
+		/** A draw_slice call, waiting for the canvas. */
+		struct SliceDraw {
+			uint16_t column;
+			SliceProjection slice;
+			uint16_t texture_offset;
+			TextureIndex kind;
+		};
+
+		/** The canvas calls of the frame, walls first. The spans (if any) are drawn before the slices.
+		Kept between frames only to avoid allocating them every time. */
+		std::vector<SliceDraw> slice_draws;
+		std::vector<WallSpan> span_draws;
+
+		/** Rows already painted by the sprites, only for the front to back order. */
+		ColumnCoverage coverage;
+
+		void cast_walls(const Grid& grid, const Camera& camera);
+		void fill_between_samples(const Grid& grid, const Camera& camera, const uint16_t first_column, const uint16_t last_column);
+		RayHit search_wall(const Grid& grid, const Camera& camera, const uint16_t column);
+		Ray column_ray(const Camera& camera, const uint16_t column) const;
+
+		void project_wall_spans(const uint8_t cell_size);
+		void project_wall_run(const uint16_t first_column, const uint16_t last_column, const uint8_t cell_size);
+		void project_sprites(const World& world, const Camera& camera);
+		void draw_sprite_slice(const uint16_t column, const SliceProjection& slice, const uint16_t texture_offset, const TextureIndex kind);
+		void cull_sprites(const std::vector<Sprite>& sprites, const ObjectBits& potentially_visible,
+			const Camera& camera, const float cos_orientation, const float sin_orientation);
+
+		/** Light level of something at that distance, with the fog if it is on. */
+		uint8_t shade(const float distance) const noexcept;
+
+		static uint32_t pov_distance(uint16_t h_resolution, float FOV_degrees);
+		static std::vector<float> compute_column_angles(const uint16_t columns, const float scan_step_radians);
+		static float to_radians(const float degrees);
 	};
-}
 
+
+	template <typename CANVAS>
+	void ProjectionPlane::project_objects(const World& world, CANVAS& c)
+	{
+		project_objects(world, world.player.camera(), c);
+	}
+
+	template <typename CANVAS>
+	void ProjectionPlane::project_objects(const World& world, const Camera& camera, CANVAS& c)
+	{
+		prepare(world, camera);
+		draw(c);
+	}
+
+	template <typename CANVAS>
+	void ProjectionPlane::draw(CANVAS& c) const
+	{
+		for (const WallSpan& span : span_draws)
+			c.draw_span(span, TextureIndex::WALL);
+
+		for (const SliceDraw& draw : slice_draws)
+			c.draw_slice(draw.column, draw.slice, draw.texture_offset, draw.kind);
+	}
+}
@@ -1,31 +1,33 @@
 #include "pch.h"
 
-#include "PI.h"
 #include "Ray.h"
 
 namespace rc {
-	Ray::Ray(const float x, const float z, const float alpha_rad) :
+	Ray::Ray(const float x, const float z, const BinaryAngle alpha) :
 		x(x),
 		z(z),
-		alpha_rad(alpha_rad)
+		alpha(alpha)
 	{}
 
 	bool Ray::facing_up() const noexcept
 	{
-		return (0 <= alpha_rad && alpha_rad < PI);
+		return alpha.facing_up();
 	}
 
 	bool Ray::facing_right() const noexcept
 	{
-		// This expression makes me wonder if it would be better to normalize angles between -PI and +PI.
-		return (0 <= alpha_rad && alpha_rad < PI / 2) || (3 * PI / 2 <= alpha_rad && alpha_rad < 2 * PI);
+		// It was a double range check on the radians, before the binary angles.
+		return alpha.facing_right();
 	}
 
 	RayHit::RayHit() :
 		x(0),
 		z(0),
 		distance(RayHit::NO_HIT),
-		offset(0)
+		offset(0),
+		cell_x(0),
+		cell_z(0),
+		face(WallFace::NONE)
 	{}
 
 	bool RayHit::no_hit() const noexcept {
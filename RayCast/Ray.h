@@ -2,6 +2,7 @@
 
 #include <cstdint>
 
+#include "BinaryAngle.h"
 #include "Canvas.h" // TODO this really should not be there!!!
 
 /** Structures to describe the generic ray, to support all the ray-casting variants. */
@@ -20,17 +21,28 @@ namespace rc{
 */
 	class Ray {
 	public:
-		Ray(const float x, const float z, const float alpha_rad);
+		/** The angle can be given in radians as well (see BinaryAngle). */
+		Ray(const float x, const float z, const BinaryAngle alpha);
 		float x;
 		float z;
-		float alpha_rad;
+		BinaryAngle alpha;
 
-		bool facing_up() const noexcept;  // TODO: test.
-		bool facing_right() const noexcept;  // TODO: test.
+		bool facing_up() const noexcept;
+		bool facing_right() const noexcept;
 
 	};
 
 
+	/** Which side of a grid cell was hit. Bottom is the side with the lower Z, left the one with the lower X. */
+	enum class WallFace : uint8_t {
+		NONE,
+		BOTTOM,
+		TOP,
+		LEFT,
+		RIGHT
+	};
+
+
 	/** Represent the hit of a ray on an object, carrying the data to the rest of the system.
 	It remembers the exact coordinates of the hit, the distance of the intersection
 	from the ray origin and the offset along the cell/object side of the hit (useful for texturing).
@@ -55,6 +67,12 @@ namespace rc{
 		uint8_t hit_object_id; /// May not be always set. TODO: smell...
 		TextureIndex type; // May not be set. Also TODO even more smell.
 
+		/** Only for the walls: the cell and its side that was hit. Neighbour rays that hit the same face
+		see the same flat piece of wall. */
+		uint8_t cell_x;
+		uint8_t cell_z;
+		WallFace face;
+
 	private:
 		static constexpr float NO_HIT = -1;  // This is an impossible value for the distance.
 	};
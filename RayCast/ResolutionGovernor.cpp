@@ -0,0 +1,64 @@
+#include "pch.h"
+#include "ResolutionGovernor.h"
+
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+namespace rc {
+
+	ResolutionGovernor::ResolutionGovernor(std::vector<uint16_t> column_levels, const float frame_budget_ms) :
+		column_levels(sorted_levels(std::move(column_levels))),
+		frame_budget_ms(frame_budget_ms),
+		current_level(0),
+		smoothed_ms(0),
+		frames_at_level(0)
+	{
+	}
+
+	uint8_t ResolutionGovernor::level() const noexcept
+	{
+		return current_level;
+	}
+
+	uint16_t ResolutionGovernor::columns() const noexcept
+	{
+		return column_levels[current_level];
+	}
+
+	void ResolutionGovernor::frame_rendered(const float milliseconds) noexcept
+	{
+		smoothed_ms = frames_at_level == 0 ? milliseconds : smoothed_ms + SMOOTHING * (milliseconds - smoothed_ms);
+		++frames_at_level;
+
+		if (frames_at_level < SETTLE_FRAMES)
+			return;
+
+		// The most columns that fit, or the fewest if nothing does.
+		const float ms_per_column = smoothed_ms / columns();
+		uint8_t best_level = (uint8_t) (column_levels.size() - 1);
+		for (uint8_t candidate = 0; candidate < column_levels.size(); ++candidate)
+			if (ms_per_column * column_levels[candidate] <= frame_budget_ms * HEADROOM) {
+				best_level = candidate;
+				break;
+			}
+
+		// Down as soon as the budget is exceeded, up only with some margin. In between, stay.
+		const bool over_budget = smoothed_ms > frame_budget_ms;
+		const bool can_go_up = best_level < current_level;
+		if ((over_budget || can_go_up) && best_level != current_level) {
+			current_level = best_level;
+			frames_at_level = 0;
+		}
+	}
+
+	std::vector<uint16_t> ResolutionGovernor::sorted_levels(std::vector<uint16_t> levels)
+	{
+		if (levels.empty())
+			throw std::runtime_error("At least a resolution level is needed.");
+
+		std::sort(levels.begin(), levels.end(), std::greater<uint16_t>());
+		return levels;
+	}
+}
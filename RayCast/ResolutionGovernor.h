@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rc {
+
+	/** Chooses how many columns to ray cast, to stay within a time budget for each frame.
+
+	The caller prepares a ProjectionPlane (and whatever else depends on the columns) for each of the
+	column_levels once, at start up. Then it tells after every frame how long the rendering took, and
+	renders the next frame with the level that the governor chooses. The image is stretched to the window.
+
+	The cost of the frame is assumed proportional to the columns. The time is smoothed over the last frames,
+	and the level can change only after it had some frames to settle: a single slow frame should not
+	make the picture blurry, and the resolution should not flicker up and down.
+	*/
+	class ResolutionGovernor {
+	public:
+		/** Starts with the most columns. Throws if there are no levels. */
+		ResolutionGovernor(std::vector<uint16_t> column_levels, const float frame_budget_ms);
+
+		/** Index in column_levels, sorted from the most to the fewest columns. */
+		uint8_t level() const noexcept;
+		uint16_t columns() const noexcept;
+
+		/** Time taken to render the last frame at the current level. May change the level for the next. */
+		void frame_rendered(const float milliseconds) noexcept;
+
+		const std::vector<uint16_t> column_levels;
+		const float frame_budget_ms;
+
+	private:
+		static constexpr float SMOOTHING = 0.2f;  /// Weight of the last frame in the average.
+		static constexpr uint16_t SETTLE_FRAMES = 10;  /// Frames at a level before changing again.
+		static constexpr float HEADROOM = 0.85f;  /// Go up only when the predicted time is well within the budget.
+
+		uint8_t current_level;
+		float smoothed_ms;
+		uint16_t frames_at_level;
+
+		static std::vector<uint16_t> sorted_levels(std::vector<uint16_t> levels);
+	};
+}
@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "Shading.h"
+
+#include <algorithm>
+
+namespace rc {
+
+	uint8_t light_level(const float distance) noexcept
+	{
+		const float level = std::min(std::max(distance, 0.0f) / LIGHT_LEVEL_DISTANCE, (float) LIGHT_LEVELS - 1);
+		return (uint8_t) level;
+	}
+
+	uint8_t fog_light_level(const float distance, const float view_distance) noexcept
+	{
+		const float fog = std::min(std::max(distance, 0.0f) / view_distance, 1.0f) * (LIGHT_LEVELS - 1);
+		return std::max(light_level(distance), (uint8_t) fog);
+	}
+
+
+	Colormap::Colormap(const uint8_t light_level)
+	{
+		const float darkening_per_level = (1 - DARKEST_BRIGHTNESS) / (LIGHT_LEVELS - 1);
+		const float brightness = 1 - std::min(light_level, (uint8_t)(LIGHT_LEVELS - 1)) * darkening_per_level;
+
+		for (uint16_t value = 0; value < channel.size(); ++value)
+			channel[value] = (uint8_t) (value * brightness + 0.5f);
+	}
+
+	uint32_t Colormap::shade(const uint32_t argb) const noexcept
+	{
+		return (argb & 0xFF000000)
+			| channel[(argb >> 16) & 0xFF] << 16
+			| channel[(argb >> 8) & 0xFF] << 8
+			| channel[argb & 0xFF];
+	}
+
+
+	ShadedTexture::ShadedTexture(const Texture& original, const uint8_t light_levels) :
+		width(original.width),
+		height(original.height),
+		light_levels(std::max(light_levels, (uint8_t) 1))
+	{
+		// Shade the small copies of the full light chain, rather than filtering again the shaded originals.
+		const std::vector<Texture> mipmaps = mip_chain(original);
+		mip_levels = (uint8_t) mipmaps.size();
+		variants.reserve((size_t) this->light_levels * mip_levels);
+
+		for (uint8_t level = 0; level < this->light_levels; ++level) {
+			const Colormap colormap(level);
+
+			for (const Texture& mipmap : mipmaps) {
+				std::vector<uint32_t> shaded_pixels(mipmap.pixels.size());
+				std::transform(mipmap.pixels.begin(), mipmap.pixels.end(), shaded_pixels.begin(),
+					[&colormap](const uint32_t p) { return colormap.shade(p); });
+
+				variants.emplace_back(mipmap.width, mipmap.height, std::move(shaded_pixels));
+			}
+		}
+	}
+
+	const Texture& ShadedTexture::variant(const uint8_t light_level, const uint8_t mip) const noexcept
+	{
+		const uint8_t available_level = std::min(light_level, (uint8_t) (light_levels - 1));
+		const uint8_t available_mip = std::min(mip, (uint8_t) (mip_levels - 1));
+		return variants[(size_t) available_level * mip_levels + available_mip];
+	}
+}
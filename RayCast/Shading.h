@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Texture.h"
+
+namespace rc {
+
+	/** Distance shading, the Doom way: the darkening is never computed while drawing.
+
+	The distance is mapped to one of few light levels. Each texture is copied once per light level at load time,
+	with all its colors already darkened (Doom did it with a table to remap the palette, a "colormap").
+	Drawing a slice then costs just the same as without shading: the texels are read from the darker copy.
+	*/
+	constexpr uint8_t LIGHT_LEVELS = 16;
+
+	/** World units (a cell is 64) between a light level and the next. */
+	constexpr float LIGHT_LEVEL_DISTANCE = 96;
+
+	/** Brightness of the last level. Not completely black, or the far walls disappear. */
+	constexpr float DARKEST_BRIGHTNESS = 0.2f;
+
+	/** 0 is full light, LIGHT_LEVELS - 1 is the darkest. */
+	uint8_t light_level(const float distance) noexcept;
+
+	/** Distance fog: the light goes down to the darkest level at the view distance, where the rays stop.
+	Never brighter than the plain light_level. */
+	uint8_t fog_light_level(const float distance, const float view_distance) noexcept;
+
+
+	/** Table to darken the color channels at the brightness of a light level. The alpha is not changed. */
+	class Colormap {
+	public:
+		explicit Colormap(const uint8_t light_level);
+
+		uint32_t shade(const uint32_t argb) const noexcept;
+
+	private:
+		std::array<uint8_t, 256> channel;
+	};
+
+
+	/** All the mipmaps of a texture, for all the light levels.
+
+	Textures that are never shaded (e. g. the HUD) can be built with a single light level: then any level
+	gives the original colors.
+	*/
+	class ShadedTexture {
+	public:
+		ShadedTexture(const Texture& original, const uint8_t light_levels);
+
+		/** Light levels beyond the available ones are clamped to the last. */
+		const Texture& variant(const uint8_t light_level, const uint8_t mip) const noexcept;
+
+		uint16_t width;
+		uint16_t height;
+		uint8_t light_levels;
+		uint8_t mip_levels;
+
+		/** Light level after light level, each with all the mipmaps (see mip_chain). */
+		std::vector<Texture> variants;
+	};
+}
@@ -0,0 +1,157 @@
+#include "pch.h"
+#include "SoftwareCanvas.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace rc {
+
+	static bool opaque(const uint32_t argb) noexcept {
+		constexpr uint32_t half_alpha = 128;
+		return (argb >> 24) >= half_alpha;
+	}
+
+	SoftwareCanvas::SoftwareCanvas(const uint16_t width, const uint16_t height) :
+		width(width),
+		height(height),
+		pixels((size_t) width * height, 0)
+	{
+	}
+
+	void SoftwareCanvas::set_texture(const TextureIndex name, ShadedTexture texture)
+	{
+		textures.erase(name);
+		textures.emplace(name, std::move(texture));
+	}
+
+	void SoftwareCanvas::clear(const uint32_t argb) noexcept
+	{
+		std::fill(pixels.begin(), pixels.end(), argb);
+	}
+
+	uint32_t SoftwareCanvas::pixel(const uint16_t column, const uint16_t row) const noexcept
+	{
+		return pixels[(size_t) row * width + column];
+	}
+
+	/** Same choice of the mipmap as the SDL canvas, then one read from the shaded copy for each row. */
+	void SoftwareCanvas::draw_slice(const uint16_t column, const SliceProjection& slice, const uint16_t texture_offset, const TextureIndex what_to_draw)
+	{
+		if (slice.height == 0 || column >= width)
+			return;
+
+		SliceCursor cursor = slice_cursor(textures.at(what_to_draw), slice, texture_offset);
+		uint32_t* destination = pixels.data() + (size_t) cursor.top_row * width + column;
+
+		for (uint16_t row = cursor.top_row; row < cursor.bottom_row; ++row) {
+			const uint16_t texture_row = std::min<uint16_t>((uint16_t) cursor.texel, cursor.source->height - 1);
+			const uint32_t argb = cursor.source->pixel(cursor.texture_column, texture_row);
+			if (opaque(argb))
+				*destination = argb;
+
+			destination += width;
+			cursor.texel += cursor.texels_per_row;
+		}
+	}
+
+	/** Going down a column, every pixel is on another cache line: on a 4K or 8K frame, a row is tens of KB and the
+	column also walks across many pages. Here the span is drawn a row at a time, left to right, so the writes are
+	contiguous. Each column keeps its own cursor and advances it only on its rows, with the very same operations
+	of draw_slice: the pixels are the same. */
+	void SoftwareCanvas::draw_span(const WallSpan& span, const TextureIndex what_to_draw)
+	{
+		if (span.first_column >= width)
+			return;
+
+		const ShadedTexture& texture = textures.at(what_to_draw);
+		const uint16_t last_offset = span.object_size - 1;
+		const uint16_t last_column = std::min<uint16_t>(span.last_column, width - 1);
+
+		span_cursors.clear();
+		uint16_t top_row = height;
+		uint16_t bottom_row = 0;
+		for (uint16_t column = span.first_column; column <= last_column; ++column) {
+			const uint16_t texture_offset = (uint16_t) std::min(std::max(span.offset_at(column), 0.0f), (float) last_offset);
+			span_cursors.push_back(slice_cursor(texture, span.slice_at(column, height), texture_offset));
+			top_row = std::min(top_row, span_cursors.back().top_row);
+			bottom_row = std::max(bottom_row, span_cursors.back().bottom_row);
+		}
+
+		for (uint16_t row = top_row; row < bottom_row; ++row) {
+			uint32_t* destination = pixels.data() + (size_t) row * width + span.first_column;
+
+			for (SliceCursor& cursor : span_cursors) {
+				if (row >= cursor.top_row && row < cursor.bottom_row) {
+					const uint16_t texture_row = std::min<uint16_t>((uint16_t) cursor.texel, cursor.source->height - 1);
+					const uint32_t argb = cursor.source->pixel(cursor.texture_column, texture_row);
+					if (opaque(argb))
+						*destination = argb;
+
+					cursor.texel += cursor.texels_per_row;
+				}
+				++destination;
+			}
+		}
+	}
+
+	/** Same font bitmap of the SDL canvas. Nearest pixel scaling. */
+	void SoftwareCanvas::draw_text(const std::string& text, uint16_t column, const uint16_t row, const uint8_t font_size)
+	{
+		constexpr uint8_t source_letter_side = 8;
+
+		const Texture& font = textures.at(TextureIndex::FONT).variant(0, 0);
+		uint16_t cursor = column;
+
+		for (const char c : text) {
+			const int8_t glyph = font_glyph(c);
+
+			if (glyph >= 0) {
+				const uint16_t font_row = glyph / source_letter_side * source_letter_side;
+				const uint16_t font_column = glyph % source_letter_side * source_letter_side;
+
+				for (uint16_t y = 0; y < font_size; ++y)
+					for (uint16_t x = 0; x < font_size; ++x) {
+						const uint32_t argb = font.pixel(
+							font_column + x * source_letter_side / font_size,
+							font_row + y * source_letter_side / font_size);
+						plot(cursor + x, row + y, argb);
+					}
+			}
+			cursor += font_size;
+		}
+	}
+
+	void SoftwareCanvas::draw_image(uint16_t column_x, const uint16_t row_y, const TextureIndex what_to_draw)
+	{
+		const Texture& image = textures.at(what_to_draw).variant(0, 0);
+
+		for (uint16_t y = 0; y < image.height; ++y)
+			for (uint16_t x = 0; x < image.width; ++x)
+				plot(column_x + x, row_y + y, image.pixel(x, y));
+	}
+
+	SoftwareCanvas::SliceCursor SoftwareCanvas::slice_cursor(const ShadedTexture& texture, const SliceProjection& slice,
+		const uint16_t texture_offset) const noexcept
+	{
+		const float full_height = std::min(texture.width / slice.texture_step, (float) std::numeric_limits<uint16_t>::max());
+		const uint8_t level = mip_level(texture.width, (uint16_t) full_height, texture.mip_levels);
+		const Texture& source = texture.variant(slice.light_level, level);
+		const float level_scale = 1.0f / (1 << level);
+
+		SliceCursor cursor;
+		cursor.source = &source;
+		cursor.texture_column = std::min<uint16_t>(texture_offset >> level, source.width - 1);
+		cursor.texel = slice.texture_top * level_scale;
+		cursor.texels_per_row = slice.texture_step * level_scale;
+		cursor.top_row = std::min(slice.top_row, height);
+		cursor.bottom_row = std::min<uint16_t>(slice.top_row + slice.height, height);
+		return cursor;
+	}
+
+	void SoftwareCanvas::plot(const uint16_t column, const uint16_t row, const uint32_t argb) noexcept
+	{
+		if (column < width && row < height && opaque(argb))
+			pixels[(size_t) row * width + column] = argb;
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Canvas.h"
+#include "Shading.h"
+
+namespace rc {
+
+	/** A Canvas that draws in a plain array of pixels, without any graphics API.
+
+	The pixels are ARGB like the Texture ones, one row after the other. Whoever owns the canvas can copy them
+	to the screen (or to a file, or compare them in a test).
+
+	There is no blending: a texel is either opaque and overwrites the pixel or it is transparent (alpha below 128,
+	the same threshold of AlphaMask) and it is skipped.
+	*/
+	class SoftwareCanvas : public Canvas {
+	public:
+		SoftwareCanvas(const uint16_t width, const uint16_t height);
+
+		void set_texture(const TextureIndex name, ShadedTexture texture);
+
+		/** Fills the whole frame with the color. */
+		void clear(const uint32_t argb) noexcept;
+
+		uint32_t pixel(const uint16_t column, const uint16_t row) const noexcept;
+
+		void draw_slice(const uint16_t column, const SliceProjection& slice, const uint16_t texture_offset, const TextureIndex what_to_draw) final;
+
+		/** The same pixels of the slices, drawn one row at a time (see the implementation). */
+		void draw_span(const WallSpan& span, const TextureIndex what_to_draw) final;
+
+		void draw_text(const std::string& text, uint16_t column, const uint16_t row, const uint8_t font_size) final;
+
+		void draw_image(uint16_t column_x, const uint16_t row_y, const TextureIndex what_to_draw) final;
+
+		const uint16_t width;
+		const uint16_t height;
+		std::vector<uint32_t> pixels;
+
+	private:
+		/** Where a slice reads its texture, and the rows it covers on the frame. */
+		struct SliceCursor {
+			const Texture* source;
+			uint16_t texture_column;
+			float texel;  /// Texture row of the next frame row, advanced by texels_per_row at each row.
+			float texels_per_row;
+			uint16_t top_row;
+			uint16_t bottom_row;  /// Excluded.
+		};
+
+		std::unordered_map<TextureIndex, ShadedTexture> textures;
+
+		/** The columns of the span being drawn. Kept to avoid an allocation for each span. */
+		std::vector<SliceCursor> span_cursors;
+
+		SliceCursor slice_cursor(const ShadedTexture& texture, const SliceProjection& slice, const uint16_t texture_offset) const noexcept;
+
+		void plot(const uint16_t column, const uint16_t row, const uint32_t argb) noexcept;
+	};
+}
@@ -63,13 +63,13 @@ RayHit Sprite::intersection(const Ray& ray) const
 	// OCB and OIB share a side, where the ray alpha (angle in O of IOB) and
 	// beta are side by side. Subtract them and find the angle in O of OIC.
 	const float beta = std::atan(vertical_difference / horizontal_difference);
-	const float gamma = ray.alpha_rad - beta;
+	const BinaryAngle gamma = ray.alpha - BinaryAngle(beta);
 
 	// Imagine that the sprite is always facing the observer.In the OIC triangle, the angle in
 	// C is 90. Resolve the sides with the usual trig.
 	const float distance_OC = std::sqrt(horizontal_difference * horizontal_difference + vertical_difference * vertical_difference);
-	const float distance_OI = distance_OC / std::cos(gamma);
-	float distance_CI = distance_OI * std::sin(gamma);
+	const float distance_OI = distance_OC * gamma.sec();
+	float distance_CI = distance_OI * gamma.sin();
 
 	const float half_span = size / 2;
 	RayHit result;
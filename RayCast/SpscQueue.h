@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace rc {
+
+	/** A queue between exactly two threads: one only pushes, the other only pops (single producer, single consumer).
+
+	Meant for the threads that must never wait, like the audio callback: no locks, no allocations, push and pop
+	take a bounded time. When the queue is full the push fails, the producer decides what to do (drop the item,
+	try again later...).
+
+	A ring of CAPACITY slots. The positions count the items ever pushed and popped, the slot is the position modulo
+	the capacity: equal positions mean empty, CAPACITY apart mean full. Each position is written by one thread only.
+	The release on the write and the acquire on the read of the other thread make the content of the slot visible
+	before the position that tells it is there.
+	*/
+	template <typename T, size_t CAPACITY>
+	class SpscQueue {
+		static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "The capacity must be a power of 2.");
+
+	public:
+		SpscQueue() noexcept;
+
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+		/** Producer thread only. False, and the queue does not change, when it is full. */
+		bool push(const T& item) noexcept;
+
+		/** Consumer thread only. False, and the item does not change, when the queue is empty. */
+		bool pop(T& item) noexcept;
+
+	private:
+		std::array<T, CAPACITY> slots;
+
+		// On different cache lines: the two threads do not invalidate each other's cache for nothing.
+		alignas(64) std::atomic<size_t> pop_position;  /// Written by the consumer only.
+		alignas(64) std::atomic<size_t> push_position;  /// Written by the producer only.
+	};
+
+
+	template <typename T, size_t CAPACITY>
+	SpscQueue<T, CAPACITY>::SpscQueue() noexcept :
+		slots{},
+		pop_position(0),
+		push_position(0)
+	{
+	}
+
+	template <typename T, size_t CAPACITY>
+	bool SpscQueue<T, CAPACITY>::push(const T& item) noexcept
+	{
+		const size_t position = push_position.load(std::memory_order_relaxed);
+		if (position - pop_position.load(std::memory_order_acquire) == CAPACITY)
+			return false;
+
+		slots[position % CAPACITY] = item;
+		push_position.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	template <typename T, size_t CAPACITY>
+	bool SpscQueue<T, CAPACITY>::pop(T& item) noexcept
+	{
+		const size_t position = pop_position.load(std::memory_order_relaxed);
+		if (position == push_position.load(std::memory_order_acquire))
+			return false;
+
+		item = slots[position % CAPACITY];
+		pop_position.store(position + 1, std::memory_order_release);
+		return true;
+	}
+}
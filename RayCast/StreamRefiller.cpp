@@ -0,0 +1,36 @@
+#include "pch.h"
+#include "StreamRefiller.h"
+
+namespace rc {
+
+	StreamRefiller::StreamRefiller(const std::vector<MusicStream*>& streams, const std::chrono::milliseconds period) :
+		period(period),
+		streams(streams),
+		stopping(false),
+		thread(&StreamRefiller::work, this)
+	{
+	}
+
+	StreamRefiller::~StreamRefiller()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		stop_requested.notify_all();
+
+		thread.join();
+	}
+
+	void StreamRefiller::work()
+	{
+		while (true) {
+			for (MusicStream* stream : streams)
+				stream->refill();
+
+			std::unique_lock<std::mutex> lock(mutex);
+			if (stop_requested.wait_for(lock, period, [this] { return stopping; }))
+				return;
+		}
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MusicStream.h"
+
+namespace rc {
+
+	/** The thread that keeps the music streams ahead of the audio: every period, it refills all of them.
+
+	Nothing tells it when the audio takes frames (the audio callback must not lock, nor wake up threads): it is
+	enough that the period is well shorter than the time a ring plays. The thread only waits for the period or for
+	the stop, the disk is read out of the lock.
+	*/
+	class StreamRefiller {
+	public:
+		/** Starts at once. The streams are not owned, they must live longer than the refiller. */
+		StreamRefiller(const std::vector<MusicStream*>& streams, const std::chrono::milliseconds period);
+
+		/** Stops and joins the thread. */
+		~StreamRefiller();
+
+		StreamRefiller(const StreamRefiller&) = delete;
+		StreamRefiller& operator=(const StreamRefiller&) = delete;
+
+		const std::chrono::milliseconds period;
+
+	private:
+		const std::vector<MusicStream*> streams;
+
+		std::mutex mutex;
+		std::condition_variable stop_requested;
+		bool stopping;  /// Protected by the mutex.
+
+		std::thread thread;  /// Last, it starts when everything else is ready.
+
+		void work();
+	};
+}
@@ -0,0 +1,82 @@
+#include "pch.h"
+#include "Texture.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace rc {
+
+	Texture::Texture(const uint16_t width, const uint16_t height, std::vector<uint32_t> pixels) :
+		width(width),
+		height(height),
+		pixels(std::move(pixels))
+	{
+		if (this->pixels.size() != (size_t) width * height)
+			throw std::runtime_error("Texture size does not match the pixel count.");
+	}
+
+	uint32_t Texture::pixel(const uint16_t x, const uint16_t y) const noexcept
+	{
+		return pixels[(size_t) y * width + x];
+	}
+
+	Texture Texture::half_size() const
+	{
+		const uint16_t new_width = std::max(1, width / 2);
+		const uint16_t new_height = std::max(1, height / 2);
+		std::vector<uint32_t> new_pixels;
+		new_pixels.reserve((size_t) new_width * new_height);
+
+		for (uint16_t y = 0; y < new_height; ++y)
+			for (uint16_t x = 0; x < new_width; ++x) {
+				// Odd sizes (or the last 1-pixel-wide levels) do not have a full 2x2 block: clamp to the border.
+				const uint16_t left = std::min<uint16_t>(x * 2, width - 1);
+				const uint16_t right = std::min<uint16_t>(x * 2 + 1, width - 1);
+				const uint16_t top = std::min<uint16_t>(y * 2, height - 1);
+				const uint16_t bottom = std::min<uint16_t>(y * 2 + 1, height - 1);
+				const uint32_t block[] = { pixel(left, top), pixel(right, top), pixel(left, bottom), pixel(right, bottom) };
+
+				uint32_t alpha_sum = 0;
+				uint32_t red_sum = 0;
+				uint32_t green_sum = 0;
+				uint32_t blue_sum = 0;
+				for (const uint32_t p : block) {
+					const uint32_t alpha = p >> 24;
+					alpha_sum += alpha;
+					red_sum += ((p >> 16) & 0xFF) * alpha;
+					green_sum += ((p >> 8) & 0xFF) * alpha;
+					blue_sum += (p & 0xFF) * alpha;
+				}
+
+				uint32_t averaged = (alpha_sum / 4) << 24;
+				if (alpha_sum > 0)  // Fully invisible blocks stay black.
+					averaged |= (red_sum / alpha_sum) << 16 | (green_sum / alpha_sum) << 8 | (blue_sum / alpha_sum);
+
+				new_pixels.push_back(averaged);
+			}
+
+		return Texture(new_width, new_height, std::move(new_pixels));
+	}
+
+
+	std::vector<Texture> mip_chain(const Texture& original)
+	{
+		std::vector<Texture> levels;
+		levels.push_back(original);
+
+		while (levels.back().width > 1 || levels.back().height > 1)
+			levels.push_back(levels.back().half_size());
+
+		return levels;
+	}
+
+	uint8_t mip_level(const uint16_t texture_size, const uint16_t projected_size, const uint8_t level_count) noexcept
+	{
+		uint8_t level = 0;
+		while (level + 1 < level_count && (texture_size >> (level + 1)) >= projected_size)
+			++level;
+
+		return level;
+	}
+}
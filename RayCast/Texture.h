@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rc {
+
+	/** Copy of the pixels of an image, in a format that the core classes can use without knowing the graphics API.
+
+	The pixels are 32 bits ARGB (alpha in the most significant byte, blue in the least significant one),
+	stored one row after the other starting from the top left corner - like in any bitmap file.
+	*/
+	class Texture {
+	public:
+		Texture(const uint16_t width, const uint16_t height, std::vector<uint32_t> pixels);
+
+		uint32_t pixel(const uint16_t x, const uint16_t y) const noexcept;
+
+		/** Returns a copy of the image, half as wide and half as tall (but never less than 1 pixel).
+
+		Each new pixel is the average of the 2x2 block it replaces. The colors are weighted by their alpha,
+		otherwise the (invisible) color of the transparent pixels bleeds in the sprite borders.*/
+		Texture half_size() const;
+
+		uint16_t width;
+		uint16_t height;
+		std::vector<uint32_t> pixels;
+	};
+
+
+	/** Builds the mipmaps of the texture: the original, then the half size copy, then the half of the half...
+	down to the 1x1 image.
+
+	Far walls are only a few pixels tall. Scaling down the full texture to draw them reads a lot of pixels only to
+	skip most of them, and the result flickers when the player moves (aliasing). Drawing from the smaller copy is
+	both faster and nicer.*/
+	std::vector<Texture> mip_chain(const Texture& original);
+
+	/** Chooses the smallest mipmap that is still at least as big as the projection on the screen.
+
+	Level 0 is the original texture (texture_size pixels), level 1 is half of it and so on, up to level_count - 1.
+	The size is the one of the side that is scaled (the height, for the slices).*/
+	uint8_t mip_level(const uint16_t texture_size, const uint16_t projected_size, const uint8_t level_count) noexcept;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Canvas.h"
+
+namespace rc {
+
+	/** A rectangle of a bigger canvas, where a ProjectionPlane draws as if it were the whole screen
+	(split screen, picture in picture...).
+
+	The slices are moved by the corner of the rectangle. Nothing is clipped: the plane must be as big
+	as the rectangle, and it already clips everything to its own columns and rows.
+
+	Like ProjectionPlane::project_objects, it works with any canvas type, and calls it directly.
+	*/
+	template <typename CANVAS>
+	class Viewport {
+	public:
+		Viewport(CANVAS& target, const uint16_t left, const uint16_t top, const uint16_t rows) :
+			left(left),
+			top(top),
+			rows(rows),
+			target(target)
+		{
+		}
+
+		void draw_slice(const uint16_t column, const SliceProjection& slice, const uint16_t texture_offset, const TextureIndex what_to_draw)
+		{
+			SliceProjection moved = slice;
+			moved.top_row += top;
+			target.draw_slice(column + left, moved, texture_offset, what_to_draw);
+		}
+
+		/** The target canvas would center the span on its own horizon, not on the one of the viewport.
+		So the span goes as slices, centered on the viewport rows. */
+		void draw_span(const WallSpan& span, const TextureIndex what_to_draw)
+		{
+			const uint16_t last_offset = span.object_size - 1;
+
+			for (uint16_t column = span.first_column; column <= span.last_column; ++column) {
+				const uint16_t texture_offset = (uint16_t) std::min(std::max(span.offset_at(column), 0.0f), (float) last_offset);
+				draw_slice(column, span.slice_at(column, rows), texture_offset, what_to_draw);
+			}
+		}
+
+		const uint16_t left;
+		const uint16_t top;
+		const uint16_t rows;
+
+	private:
+		CANVAS& target;
+	};
+}
@@ -0,0 +1,115 @@
+#include "pch.h"
+#include "WavReader.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace rc {
+
+	/** Wav files are little endian, whatever the machine. */
+	static uint32_t little_endian(const uint8_t* bytes, const uint8_t count) noexcept {
+		uint32_t value = 0;
+		for (uint8_t i = 0; i < count; ++i)
+			value |= (uint32_t) bytes[i] << (8 * i);
+		return value;
+	}
+
+	static uint32_t read_number(std::istream& source, const uint8_t bytes) {
+		uint8_t buffer[4] = {};
+		source.read((char*) buffer, bytes);
+		if (!source)
+			throw std::runtime_error("Wav file truncated in the header.");
+		return little_endian(buffer, bytes);
+	}
+
+	static std::string read_tag(std::istream& source) {
+		char tag[4] = {};
+		source.read(tag, sizeof(tag));
+		if (!source)
+			throw std::runtime_error("Wav file truncated in the header.");
+		return std::string(tag, sizeof(tag));
+	}
+
+
+	WavReader::WavReader(std::istream& source) :
+		channels(0),
+		frequency(0),
+		frames(0),
+		source(source),
+		position(0)
+	{
+		if (read_tag(source) != "RIFF")
+			throw std::runtime_error("Not a wav file.");
+		read_number(source, 4);  // Size of the rest of the file, not needed.
+		if (read_tag(source) != "WAVE")
+			throw std::runtime_error("Not a wav file.");
+
+		// A list of chunks (tag, size, content). Only the format and the data matter, the rest is skipped.
+		bool format_found = false;
+		while (true) {
+			const std::string chunk = read_tag(source);
+			const uint32_t size = read_number(source, 4);
+			const uint32_t padding = size % 2;  // The chunks start at even offsets.
+
+			if (chunk == "fmt ") {
+				if (size < 16)
+					throw std::runtime_error("Wav format chunk too short.");
+
+				const uint32_t encoding = read_number(source, 2);
+				channels = (uint16_t) read_number(source, 2);
+				frequency = read_number(source, 4);
+				read_number(source, 4);  // Bytes per second and per frame: they follow from the rest.
+				read_number(source, 2);
+				const uint32_t bits = read_number(source, 2);
+
+				if (encoding != 1 || bits != 16 || (channels != 1 && channels != 2))
+					throw std::runtime_error("Only 16 bits PCM wav files, mono or stereo, can be streamed.");
+
+				format_found = true;
+				source.ignore((std::streamsize) size - 16 + padding);
+			}
+			else if (chunk == "data") {
+				if (!format_found)
+					throw std::runtime_error("Wav data before the format.");
+
+				frames = size / (2 * channels);
+				data_start = source.tellg();
+				return;
+			}
+			else
+				source.ignore((std::streamsize) size + padding);
+		}
+	}
+
+	uint32_t WavReader::read(int16_t* stereo_samples, uint32_t frames)
+	{
+		frames = std::min(frames, this->frames - position);
+		const size_t frame_bytes = (size_t) 2 * channels;
+
+		if (file_bytes.size() < frames * frame_bytes)
+			file_bytes.resize(frames * frame_bytes);
+		source.read((char*) file_bytes.data(), (std::streamsize) (frames * frame_bytes));
+		const uint32_t frames_read = (uint32_t) ((size_t) source.gcount() / frame_bytes);
+
+		for (uint32_t i = 0; i < frames_read; ++i) {
+			const uint8_t* frame = file_bytes.data() + i * frame_bytes;
+			const int16_t left = (int16_t) little_endian(frame, 2);
+			stereo_samples[2 * i] = left;
+			stereo_samples[2 * i + 1] = (channels == 2) ? (int16_t) little_endian(frame + 2, 2) : left;
+		}
+
+		position += frames_read;
+		if (frames_read < frames)
+			this->frames = position;
+
+		return frames_read;
+	}
+
+	void WavReader::rewind()
+	{
+		source.clear();
+		source.seekg(data_start);
+		position = 0;
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+namespace rc {
+
+	/** Reads the frames of a wav file a piece at a time, converted as the mixer wants them: signed 16 bits, stereo,
+	interleaved (see AudioClip). Only the header is read on creation, however long the file.
+
+	Only the format of the music of the game: PCM, 16 bits, mono or stereo (a mono file plays the same on both
+	channels). Anything else throws. There is no resampling: the caller checks the frequency.
+	
+	The reader is the only one that moves in the source, which must live longer than the reader.
+	*/
+	class WavReader {
+	public:
+		/** Reads the header, up to the start of the data. Throws if it is not a wav file the reader can play. */
+		explicit WavReader(std::istream& source);
+
+		/** Fills the frames (2 samples each), returns how many there were: less than asked only at the end.
+		A file shorter than its header says ends where its data ends. */
+		uint32_t read(int16_t* stereo_samples, uint32_t frames);
+
+		/** Back to the first frame. */
+		void rewind();
+
+		uint16_t channels;  /// In the file.
+		uint32_t frequency;
+		uint32_t frames;
+
+	private:
+		std::istream& source;
+		std::streampos data_start;
+		uint32_t position;  /// Next frame to read.
+
+		/** Kept between the reads only to avoid allocating it every time. */
+		std::vector<uint8_t> file_bytes;
+
+		WavReader(const WavReader&) = delete;
+		void operator=(const WavReader&) = delete;
+	};
+}
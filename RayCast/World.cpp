@@ -100,7 +100,7 @@ namespace rc {
 			}
 		}
 
-		objects.enemies.build(10, 10); // TODO: change the tree building parameters dinamically? Avoid hardcode?
+		objects.prepare_broad_phase();
 		
 		if (!player_position_loaded)
 			throw std::runtime_error("No player on the map.");
@@ -110,7 +110,9 @@ namespace rc {
 
 		Player p{player_start_position.x, player_start_position.z, player_orientation, ammo};  // Not set: the kills, that begin at 0.
 		
-		return World{g, p, std::move(objects)};
+		World loaded{g, p, std::move(objects)};
+		loaded.visibility = PotentiallyVisibleSet(loaded.map, loaded.sprites);
+		return loaded;
 	}
 
 
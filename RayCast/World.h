@@ -1,10 +1,14 @@
 #pragma once
 
+#include <cstdint>
+
+#include "AlphaMask.h"
 #include "BackgroundMusic.h"
 #include "Grid.h"
 #include "Hud.h"
 #include "Objects.h"
 #include "Player.h"
+#include "PotentiallyVisibleSet.h"
 
 namespace rc {
 
@@ -19,10 +23,21 @@ namespace rc {
 		Hud hud;
 		BackgroundMusic music;
 
+		/** Filled when the textures are loaded. Tells the game logic which pixels of the sprites are solid. */
+		AlphaMasks masks;
+
+		/** Built by load, unless it takes too much work: then empty (everything visible), see its report. */
+		PotentiallyVisibleSet visibility;
+
 		static World load(std::istream& serialized_world);
 
 		/** Tells if the game is complete. True when the player is in the same cell as an exit. */
 		bool endgame() const;  // TODO test
+
+		/** Counts the changes to what is on the screen: whoever moves the player, kills an enemy... increments it.
+		When the version is the same of the last frame, the interface can show that frame again instead of
+		drawing an identical one. It only has to be different, wrapping around is fine. */
+		uint32_t version = 0;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include "pch.h"
+
+#include "AlphaMask.h"
+
+#include <vector>
+
+#include "Texture.h"
+
+namespace rc {
+
+    constexpr uint32_t SOLID = 0xFF808080;
+    constexpr uint32_t ALMOST_SOLID = 0x80808080;
+    constexpr uint32_t ALMOST_INVISIBLE = 0x7F808080;
+    constexpr uint32_t INVISIBLE = 0x00808080;
+
+    TEST(AlphaMask, no_texture__all_opaque) {
+        const AlphaMask m;
+
+        ASSERT_TRUE(m.opaque(0, 0));
+        ASSERT_TRUE(m.opaque(63, 10));
+        ASSERT_FALSE(m.transparent_column(5));
+    }
+
+    TEST(AlphaMask, opaque__half_alpha_threshold) {
+        const Texture t(2, 2, { SOLID, ALMOST_SOLID, ALMOST_INVISIBLE, INVISIBLE });
+        const AlphaMask m(t);
+
+        ASSERT_TRUE(m.opaque(0, 0));
+        ASSERT_TRUE(m.opaque(1, 0));
+        ASSERT_FALSE(m.opaque(0, 1));
+        ASSERT_FALSE(m.opaque(1, 1));
+    }
+
+    TEST(AlphaMask, opaque__outside_is_transparent) {
+        const Texture t(1, 1, { SOLID });
+        const AlphaMask m(t);
+
+        ASSERT_FALSE(m.opaque(1, 0));
+        ASSERT_FALSE(m.opaque(0, 1));
+    }
+
+    TEST(AlphaMask, opaque__taller_than_a_word) {
+        std::vector<uint32_t> pixels(1 * 100, INVISIBLE);
+        pixels.at(70) = SOLID;
+        const AlphaMask m(Texture(1, 100, pixels));
+
+        ASSERT_FALSE(m.opaque(0, 6));
+        ASSERT_TRUE(m.opaque(0, 70));
+        ASSERT_FALSE(m.opaque(0, 71));
+    }
+
+    TEST(AlphaMask, column_span) {
+        const Texture t(2, 4, {
+            INVISIBLE, INVISIBLE,
+            SOLID, INVISIBLE,
+            INVISIBLE, INVISIBLE,
+            SOLID, INVISIBLE });
+        const AlphaMask m(t);
+
+        ASSERT_EQ(1, m.column_span(0).first_opaque);
+        ASSERT_EQ(3, m.column_span(0).last_opaque);
+        ASSERT_FALSE(m.transparent_column(0));
+        ASSERT_TRUE(m.transparent_column(1));
+    }
+
+    TEST(AlphaMask, visible_runs) {
+        const Texture t(2, 5, {
+            SOLID, INVISIBLE,
+            SOLID, INVISIBLE,
+            INVISIBLE, INVISIBLE,
+            SOLID, INVISIBLE,
+            INVISIBLE, INVISIBLE });
+        const AlphaMask m(t);
+
+        const AlphaMask::RunRange runs = m.visible_runs(0);
+        ASSERT_EQ(2, runs.end() - runs.begin());
+        ASSERT_EQ(0, runs.begin()[0].first_row);
+        ASSERT_EQ(2, runs.begin()[0].end_row);
+        ASSERT_EQ(3, runs.begin()[1].first_row);
+        ASSERT_EQ(4, runs.begin()[1].end_row);
+
+        ASSERT_TRUE(m.visible_runs(1).empty());
+        ASSERT_TRUE(m.visible_runs(2).empty());
+    }
+
+    TEST(AlphaMask, visible_runs__keep_soft_edges) {
+        const Texture t(1, 5, {
+            INVISIBLE,
+            ALMOST_INVISIBLE,
+            SOLID,
+            ALMOST_INVISIBLE,
+            INVISIBLE });
+        const AlphaMask m(t);
+
+        const AlphaMask::RunRange runs = m.visible_runs(0);
+        ASSERT_EQ(1, runs.end() - runs.begin());
+        ASSERT_EQ(1, runs.begin()->first_row);
+        ASSERT_EQ(4, runs.begin()->end_row);
+
+        ASSERT_FALSE(m.opaque(0, 1));
+        ASSERT_EQ(2, m.column_span(0).first_opaque);
+        ASSERT_EQ(2, m.column_span(0).last_opaque);
+    }
+
+    TEST(AlphaMask, visible_runs__no_texture_one_run) {
+        const AlphaMask m;
+
+        const AlphaMask::RunRange runs = m.visible_runs(7);
+        ASSERT_EQ(1, runs.end() - runs.begin());
+        ASSERT_EQ(0, runs.begin()->first_row);
+    }
+
+    TEST(AlphaMasks, by_texture_index) {
+        AlphaMasks masks;
+        masks.set(TextureIndex::ENEMY, AlphaMask(Texture(1, 1, { INVISIBLE })));
+
+        ASSERT_FALSE(masks.of(TextureIndex::ENEMY).opaque(0, 0));
+        ASSERT_TRUE(masks.of(TextureIndex::EXIT).opaque(0, 0));
+        ASSERT_TRUE(masks.of(TextureIndex::WALL).opaque(0, 0));
+    }
+}
@@ -0,0 +1,200 @@
+#include "pch.h"
+
+#include "AudioMixer.h"
+
+#include <vector>
+
+#include "TestWav.h"
+
+namespace rc {
+
+    /** The same sample on both channels, for each frame. */
+    static AudioClip clip_of(const std::vector<int16_t>& frames) {
+        AudioClip clip;
+        for (const int16_t sample : frames) {
+            clip.samples.push_back(sample);
+            clip.samples.push_back(sample);
+        }
+        return clip;
+    }
+
+    static std::vector<int16_t> mix(AudioMixer& mixer, const uint32_t frames) {
+        std::vector<int16_t> output(frames * 2, 1234);
+        mixer.mix(output.data(), frames);
+        return output;
+    }
+
+    TEST(AudioMixer, creation__no_voices) {
+        ASSERT_ANY_THROW(AudioMixer(0, 16));
+        ASSERT_ANY_THROW(AudioMixer(AudioMixer::NO_VOICE, 16));
+    }
+
+    TEST(AudioMixer, mix__silence) {
+        AudioMixer mixer(4, 16);
+
+        ASSERT_EQ(std::vector<int16_t>(10, 0), mix(mixer, 5));
+    }
+
+    TEST(AudioMixer, mix__one_voice_unchanged) {
+        AudioMixer mixer(4, 16);
+        const AudioClip clip = clip_of({ 1, -2, 300, -4000, 32767, -32768, 7, 8, 9 });  // Not a multiple of 4 frames.
+        mixer.play(clip, 1, 0, AudioMixer::Repetition::ONCE);
+
+        ASSERT_EQ(clip.samples, mix(mixer, 9));
+    }
+
+    TEST(AudioMixer, mix__voices_add_up) {
+        AudioMixer mixer(4, 16);
+        const AudioClip first = clip_of({ 100, 200, 300, 400, 500 });
+        const AudioClip second = clip_of({ 10, 20, 30, 40, 50 });
+        mixer.play(first, 1, 0, AudioMixer::Repetition::ONCE);
+        mixer.play(second, 1, 0, AudioMixer::Repetition::ONCE);
+
+        ASSERT_EQ(clip_of({ 110, 220, 330, 440, 550 }).samples, mix(mixer, 5));
+    }
+
+    TEST(AudioMixer, mix__saturates) {
+        AudioMixer mixer(4, 16);
+        const AudioClip loud = clip_of({ 30000, -30000, 30000, -30000, 30000, -30000, 30000, -30000, 30000 });
+        mixer.play(loud, 1, 0, AudioMixer::Repetition::ONCE);
+        mixer.play(loud, 1, 0, AudioMixer::Repetition::ONCE);
+
+        ASSERT_EQ(clip_of({ 32767, -32768, 32767, -32768, 32767, -32768, 32767, -32768, 32767 }).samples, mix(mixer, 9));
+    }
+
+    TEST(AudioMixer, mix__gain) {
+        AudioMixer mixer(4, 16);
+        const AudioClip clip = clip_of({ 1000, -1000, 20000, -20000, 1000, -1000, 20000, -20000, 1000 });
+        mixer.play(clip, 0.5f, 0, AudioMixer::Repetition::ONCE);
+
+        ASSERT_EQ(clip_of({ 500, -500, 10000, -10000, 500, -500, 10000, -10000, 500 }).samples, mix(mixer, 9));
+    }
+
+    TEST(AudioMixer, mix__pan) {
+        AudioMixer mixer(4, 16);
+        const AudioClip clip = clip_of({ 1000, 1000, 1000, 1000, 1000 });
+        mixer.play(clip, 1, 0.5f, AudioMixer::Repetition::ONCE);
+
+        const std::vector<int16_t> output = mix(mixer, 5);
+
+        for (size_t frame = 0; frame < 5; ++frame) {
+            ASSERT_EQ(500, output[frame * 2]);  // Left.
+            ASSERT_EQ(1000, output[frame * 2 + 1]);  // Right.
+        }
+    }
+
+    TEST(AudioMixer, mix__once_ends) {
+        AudioMixer mixer(4, 16);
+        const AudioClip clip = clip_of({ 1, 2 });
+        const AudioMixer::VoiceId voice = mixer.play(clip, 1, 0, AudioMixer::Repetition::ONCE);
+
+        ASSERT_EQ(clip_of({ 1, 2, 0, 0 }).samples, mix(mixer, 4));
+        ASSERT_FALSE(mixer.playing(voice));
+    }
+
+    TEST(AudioMixer, mix__loop_starts_again) {
+        AudioMixer mixer(4, 16);
+        const AudioClip clip = clip_of({ 1, 2, 3 });
+        const AudioMixer::VoiceId voice = mixer.play(clip, 1, 0, AudioMixer::Repetition::LOOP);
+
+        ASSERT_EQ(clip_of({ 1, 2, 3, 1, 2, 3, 1 }).samples, mix(mixer, 7));
+        ASSERT_EQ(clip_of({ 2, 3 }).samples, mix(mixer, 2));
+        ASSERT_TRUE(mixer.playing(voice));
+    }
+
+    TEST(AudioMixer, mix__longer_than_a_block) {
+        AudioMixer mixer(4, 2);
+        const AudioClip clip = clip_of({ 1, 2, 3, 4, 5 });
+        mixer.play(clip, 1, 0, AudioMixer::Repetition::ONCE);
+
+        ASSERT_EQ(clip.samples, mix(mixer, 5));
+    }
+
+    TEST(AudioMixer, mix__silent_voice_keeps_its_place) {
+        AudioMixer mixer(4, 16);
+        const AudioClip clip = clip_of({ 1, 2, 3, 4 });
+        const AudioMixer::VoiceId voice = mixer.play(clip, 0, 0, AudioMixer::Repetition::LOOP);
+
+        ASSERT_EQ(clip_of({ 0, 0 }).samples, mix(mixer, 2));
+        mixer.set_gain(voice, 1, 0);
+        ASSERT_EQ(clip_of({ 3, 4 }).samples, mix(mixer, 2));
+    }
+
+    TEST(AudioMixer, play__steals_the_oldest_once_voice) {
+        AudioMixer mixer(3, 16);
+        const AudioClip music = clip_of({ 1, 1, 1 });
+        const AudioClip shot = clip_of({ 10, 10, 10 });
+        const AudioMixer::VoiceId music_voice = mixer.play(music, 1, 0, AudioMixer::Repetition::LOOP);
+        const AudioMixer::VoiceId first_shot = mixer.play(shot, 1, 0, AudioMixer::Repetition::ONCE);
+        const AudioMixer::VoiceId second_shot = mixer.play(shot, 1, 0, AudioMixer::Repetition::ONCE);
+
+        const AudioMixer::VoiceId third_shot = mixer.play(shot, 1, 0, AudioMixer::Repetition::ONCE);
+
+        ASSERT_EQ(first_shot, third_shot);
+        ASSERT_NE(second_shot, third_shot);
+        ASSERT_TRUE(mixer.playing(music_voice));
+        ASSERT_EQ(3, mixer.voices_playing());
+    }
+
+    TEST(AudioMixer, play__loops_never_stolen) {
+        AudioMixer mixer(2, 16);
+        const AudioClip music = clip_of({ 1, 1, 1 });
+        mixer.play(music, 1, 0, AudioMixer::Repetition::LOOP);
+        mixer.play(music, 1, 0, AudioMixer::Repetition::LOOP);
+
+        ASSERT_EQ(AudioMixer::NO_VOICE, mixer.play(music, 1, 0, AudioMixer::Repetition::ONCE));
+    }
+
+    TEST(AudioMixer, play__empty_clip) {
+        AudioMixer mixer(2, 16);
+
+        ASSERT_EQ(AudioMixer::NO_VOICE, mixer.play(AudioClip(), 1, 0, AudioMixer::Repetition::LOOP));
+    }
+
+    TEST(AudioMixer, stop) {
+        AudioMixer mixer(2, 16);
+        const AudioClip clip = clip_of({ 5, 5 });
+        const AudioMixer::VoiceId voice = mixer.play(clip, 1, 0, AudioMixer::Repetition::LOOP);
+
+        mixer.stop(voice);
+
+        ASSERT_FALSE(mixer.playing(voice));
+        ASSERT_EQ(clip_of({ 0, 0 }).samples, mix(mixer, 2));
+    }
+
+    TEST(AudioMixer, play__stream_same_as_clip) {
+        const std::vector<int16_t> samples({ 1, -2, 300, -4000, 32767, -32768, 7, 8, 9, 10 });
+        MusicStream stream(wav_stream(samples, 2), 16);
+        AudioClip clip;
+        clip.samples = samples;
+        AudioMixer stream_mixer(4, 3);
+        AudioMixer clip_mixer(4, 3);
+
+        stream_mixer.play(stream, 0.75f, 0.5f);
+        clip_mixer.play(clip, 0.75f, 0.5f, AudioMixer::Repetition::ONCE);
+
+        ASSERT_EQ(mix(clip_mixer, 5), mix(stream_mixer, 5));
+    }
+
+    TEST(AudioMixer, play__silent_stream_keeps_its_place) {
+        MusicStream stream(wav_stream({ 1, 2, 3, 4 }, 1), 16);
+        AudioMixer mixer(4, 16);
+        const AudioMixer::VoiceId voice = mixer.play(stream, 0, 0);
+
+        ASSERT_EQ(clip_of({ 0, 0 }).samples, mix(mixer, 2));
+        mixer.set_gain(voice, 1, 0);
+
+        ASSERT_EQ(clip_of({ 3, 4 }).samples, mix(mixer, 2));
+    }
+
+    TEST(AudioMixer, play__streams_never_stolen) {
+        MusicStream stream(wav_stream({ 1, 2, 3 }, 1), 16);
+        const AudioClip clip = clip_of({ 1, 1, 1 });
+        AudioMixer mixer(1, 16);
+        const AudioMixer::VoiceId voice = mixer.play(stream, 1, 0);
+
+        ASSERT_EQ(AudioMixer::NO_VOICE, mixer.play(clip, 1, 0, AudioMixer::Repetition::ONCE));
+        mixer.stop(voice);
+        ASSERT_EQ(0, mixer.voices_playing());
+    }
+}
@@ -0,0 +1,85 @@
+#include "pch.h"
+
+#include "BinaryAngle.h"
+
+#include <cmath>
+
+#include "PI.h"
+
+namespace rc {
+
+    TEST(BinaryAngle, construction) {
+        ASSERT_EQ(0, BinaryAngle().units);
+        ASSERT_EQ(0x4000, BinaryAngle(PI / 2).units);
+        ASSERT_EQ(0x8000, BinaryAngle(PI).units);
+        ASSERT_EQ(0xC000, BinaryAngle(3 * PI / 2).units);
+    }
+
+    TEST(BinaryAngle, construction__wraps) {
+        ASSERT_EQ(0, BinaryAngle(2 * PI).units);
+        ASSERT_EQ(0xC000, BinaryAngle(-PI / 2).units);
+        ASSERT_EQ(0x4000, BinaryAngle(4 * PI + PI / 2).units);
+    }
+
+    TEST(BinaryAngle, radians) {
+        ASSERT_FLOAT_EQ(PI, BinaryAngle::from_units(0x8000).radians());
+        ASSERT_NEAR(1.2345f, BinaryAngle(1.2345f).radians(), BinaryAngle::RESOLUTION_RADIANS / 2);
+    }
+
+    TEST(BinaryAngle, sum__wraps) {
+        const BinaryAngle almost_full_turn = BinaryAngle::from_units(0xFFF0);
+
+        ASSERT_EQ(0x0010, (almost_full_turn + BinaryAngle::from_units(0x0020)).units);
+        ASSERT_EQ(0xFFE0, (BinaryAngle::from_units(0x0010) - BinaryAngle::from_units(0x0030)).units);
+    }
+
+    TEST(BinaryAngle, sum__many_times) {
+        BinaryAngle angle;
+        const BinaryAngle step(0.1f);
+
+        for (uint32_t i = 0; i < 100000; ++i)
+            angle += step;
+
+        ASSERT_EQ((uint16_t) (step.units * 100000), angle.units);  // No rounding error piling up.
+    }
+
+    TEST(BinaryAngle, trigonometry) {
+        for (float radians = -7; radians < 7; radians += 0.01f) {
+            const BinaryAngle angle(radians);
+            const double exact = angle.units * 2 * 3.141592653589793 / BinaryAngle::FULL_TURN;
+
+            ASSERT_NEAR(std::sin(exact), angle.sin(), 1e-7);
+            ASSERT_NEAR(std::cos(exact), angle.cos(), 1e-7);
+            ASSERT_NEAR(std::tan(exact), angle.tan(), std::abs(std::tan(exact)) * 1e-7);
+            ASSERT_NEAR(1 / std::cos(exact), angle.sec(), std::abs(1 / std::cos(exact)) * 1e-7);
+        }
+    }
+
+    TEST(BinaryAngle, trigonometry__exact_quarters) {
+        ASSERT_EQ(0, BinaryAngle().sin());
+        ASSERT_EQ(1, BinaryAngle().cos());
+        ASSERT_EQ(1, BinaryAngle(PI / 2).sin());
+        ASSERT_EQ(0, BinaryAngle(PI / 2).cos());
+        ASSERT_EQ(0, BinaryAngle(PI).sin());
+        ASSERT_EQ(-1, BinaryAngle(PI).cos());
+        ASSERT_EQ(1, BinaryAngle(PI / 4).tan());
+    }
+
+    TEST(BinaryAngle, trigonometry__vertical_is_finite) {
+        ASSERT_TRUE(std::isfinite(BinaryAngle(PI / 2).tan()));
+        ASSERT_GT(std::abs(BinaryAngle(PI / 2).tan()), 1e10f);
+        ASSERT_TRUE(std::isfinite(BinaryAngle(3 * PI / 2).sec()));
+    }
+
+    TEST(BinaryAngle, facing) {
+        ASSERT_TRUE(BinaryAngle::from_units(0x0000).facing_up());
+        ASSERT_TRUE(BinaryAngle::from_units(0x7FFF).facing_up());
+        ASSERT_FALSE(BinaryAngle::from_units(0x8000).facing_up());
+        ASSERT_FALSE(BinaryAngle::from_units(0xFFFF).facing_up());
+
+        ASSERT_TRUE(BinaryAngle::from_units(0x3FFF).facing_right());
+        ASSERT_FALSE(BinaryAngle::from_units(0x4000).facing_right());
+        ASSERT_FALSE(BinaryAngle::from_units(0xBFFF).facing_right());
+        ASSERT_TRUE(BinaryAngle::from_units(0xC000).facing_right());
+    }
+}
@@ -0,0 +1,33 @@
+#include "pch.h"
+
+#include "Camera.h"
+
+#include "PI.h"
+
+namespace rc {
+
+    TEST(Camera, interpolate__ends) {
+        const Camera from{ 10, 20, 1 };
+        const Camera to{ 30, 60, 2 };
+
+        ASSERT_EQ(from, interpolate(from, to, 0));
+        ASSERT_EQ(to, interpolate(from, to, 1));
+    }
+
+    TEST(Camera, interpolate__half_way) {
+        const Camera result = interpolate(Camera{ 10, 20, 1 }, Camera{ 30, 60, 2 }, 0.5f);
+
+        ASSERT_FLOAT_EQ(20, result.x);
+        ASSERT_FLOAT_EQ(40, result.z);
+        ASSERT_NEAR(1.5f, result.orientation.radians(), BinaryAngle::RESOLUTION_RADIANS);
+    }
+
+    TEST(Camera, interpolate__turns_the_short_way) {
+        const Camera from{ 0, 0, 2 * PI - 0.2f };
+        const Camera to{ 0, 0, 0.2f };
+
+        const Camera result = interpolate(from, to, 0.25f);
+
+        ASSERT_NEAR(2 * PI - 0.1f, result.orientation.radians(), 2 * BinaryAngle::RESOLUTION_RADIANS);
+    }
+}
@@ -0,0 +1,53 @@
+#include "pch.h"
+
+#include "Canvas.h"
+
+#include "ProjectionPlane.h"
+
+namespace rc {
+
+    static WallSpan oblique_span() {
+        WallSpan s;
+        s.first_column = 10;
+        s.last_column = 20;
+        s.first_height = 100;
+        s.last_height = 50;
+        s.first_offset = 0;
+        s.last_offset = 60;
+        s.object_size = 64;
+        s.light_level = 3;
+        return s;
+    }
+
+    TEST(WallSpan, ends_exact) {
+        const WallSpan s = oblique_span();
+
+        ASSERT_EQ(100, s.height_at(10));
+        ASSERT_EQ(50, s.height_at(20));
+        ASSERT_EQ(0, s.offset_at(10));
+        ASSERT_EQ(60, s.offset_at(20));
+    }
+
+    TEST(WallSpan, perspective_interpolation) {
+        const WallSpan s = oblique_span();
+
+        // Half way on the screen is not half way on the wall: the close part takes more columns.
+        ASSERT_FLOAT_EQ(75, s.height_at(15));
+        ASSERT_FLOAT_EQ(20, s.offset_at(15));
+    }
+
+    TEST(WallSpan, slice_at__same_as_projection) {
+        const ProjectionPlane p(320, 200, 60);
+        WallSpan s = oblique_span();
+        s.first_height = 277.0f * 64 / 100;  // A wall at distance 100, as ProjectionPlane computes it.
+
+        const SliceProjection expected = p.project_slice(100, 64);
+        const SliceProjection result = s.slice_at(10, 200);
+
+        ASSERT_EQ(expected.top_row, result.top_row);
+        ASSERT_EQ(expected.height, result.height);
+        ASSERT_FLOAT_EQ(expected.texture_top, result.texture_top);
+        ASSERT_FLOAT_EQ(expected.texture_step, result.texture_step);
+        ASSERT_EQ(3, result.light_level);
+    }
+}
@@ -0,0 +1,87 @@
+#include "pch.h"
+
+#include "ColumnCoverage.h"
+
+#include <vector>
+
+namespace rc {
+
+    static std::vector<ColumnCoverage::RowSpan> free_spans(const ColumnCoverage& coverage, const uint16_t top, const uint16_t bottom) {
+        std::vector<ColumnCoverage::RowSpan> spans;
+        coverage.for_each_free_span(0, top, bottom,
+            [&spans](const ColumnCoverage::RowSpan& span) { spans.push_back(span); });
+        return spans;
+    }
+
+    TEST(ColumnCoverage, nothing_covered) {
+        const ColumnCoverage c(2, 100);
+
+        const auto spans = free_spans(c, 10, 20);
+
+        ASSERT_EQ(1, spans.size());
+        ASSERT_EQ(10, spans.at(0).top);
+        ASSERT_EQ(20, spans.at(0).bottom);
+        ASSERT_FALSE(c.full(0));
+    }
+
+    TEST(ColumnCoverage, hole_in_the_middle) {
+        ColumnCoverage c(2, 100);
+        c.cover(0, 12, 15);
+
+        const auto spans = free_spans(c, 10, 20);
+
+        ASSERT_EQ(2, spans.size());
+        ASSERT_EQ(10, spans.at(0).top);
+        ASSERT_EQ(12, spans.at(0).bottom);
+        ASSERT_EQ(15, spans.at(1).top);
+        ASSERT_EQ(20, spans.at(1).bottom);
+    }
+
+    TEST(ColumnCoverage, all_covered) {
+        ColumnCoverage c(2, 100);
+        c.cover(0, 0, 50);
+
+        ASSERT_TRUE(free_spans(c, 10, 20).empty());
+    }
+
+    TEST(ColumnCoverage, other_column_not_covered) {
+        ColumnCoverage c(2, 100);
+        c.cover(1, 0, 100);
+
+        ASSERT_EQ(1, free_spans(c, 0, 100).size());
+        ASSERT_TRUE(c.full(1));
+    }
+
+    TEST(ColumnCoverage, cover__merges_spans) {
+        ColumnCoverage c(1, 100);
+        c.cover(0, 0, 10);
+        c.cover(0, 50, 100);
+        ASSERT_FALSE(c.full(0));
+
+        c.cover(0, 10, 50);
+
+        ASSERT_TRUE(c.full(0));
+    }
+
+    TEST(ColumnCoverage, cover__overlapping_spans) {
+        ColumnCoverage c(1, 100);
+        c.cover(0, 20, 30);
+        c.cover(0, 40, 45);
+        c.cover(0, 25, 42);
+
+        const auto spans = free_spans(c, 0, 100);
+
+        ASSERT_EQ(2, spans.size());
+        ASSERT_EQ(20, spans.at(0).bottom);
+        ASSERT_EQ(45, spans.at(1).top);
+    }
+
+    TEST(ColumnCoverage, clear) {
+        ColumnCoverage c(1, 100);
+        c.cover(0, 0, 100);
+
+        c.clear();
+
+        ASSERT_FALSE(c.full(0));
+    }
+}
@@ -0,0 +1,92 @@
+#include "pch.h"
+
+#include "FixedProjectionPlane.h"
+
+#include <cmath>
+#include <sstream>
+
+#include "MockInterface.h"
+#include "World.h"
+
+namespace rc {
+
+    using KioskPlane = FixedProjectionPlane<640, 480, 60>;
+
+    // All computed by the compiler.
+    static_assert(KioskPlane::DISTANCE_TO_POV == 554, "Wrong compile time distance.");
+    static_assert(KioskPlane::X_CENTER == 320 && KioskPlane::Y_CENTER == 240, "Wrong compile time center.");
+    static_assert(KioskPlane::COLUMN_ANGLES[320] == 0, "The central column looks straight ahead.");
+
+    TEST(compile_time, trigonometry) {
+        for (double radians = -1.6; radians < 1.6; radians += 0.01) {
+            ASSERT_NEAR(std::sin(radians), compile_time::sin(radians), 1e-15);
+            ASSERT_NEAR(std::cos(radians), compile_time::cos(radians), 1e-15);
+            ASSERT_NEAR(std::tan(radians), compile_time::tan(radians), std::abs(std::tan(radians)) * 1e-12);  // Close to PI / 2 the tangent is touchy.
+        }
+    }
+
+    TEST(FixedProjectionPlane, same_as_runtime_plane) {
+        const ProjectionPlane runtime(640, 480, 60);
+        const KioskPlane fixed;
+
+        ASSERT_EQ(runtime.columns, fixed.columns);
+        ASSERT_EQ(runtime.rows, fixed.rows);
+        ASSERT_EQ(runtime.x_center, fixed.x_center);
+        ASSERT_EQ(runtime.y_center, fixed.y_center);
+        ASSERT_EQ(runtime.distance_to_POV, fixed.distance_to_POV);
+        ASSERT_EQ(runtime.scan_step_radians, fixed.scan_step_radians);
+        ASSERT_EQ(runtime.column_angles, fixed.column_angles);
+        ASSERT_EQ(runtime.column_directions, fixed.column_directions);
+    }
+
+    TEST(FixedProjectionPlane, fishbowl_as_binary_angles) {
+        const KioskPlane fixed;
+
+        for (uint16_t column = 0; column < KioskPlane::COLUMNS; ++column)
+            ASSERT_EQ(fixed.column_directions[column].cos(), KioskPlane::FISHBOWL[column]);
+    }
+
+    TEST(FixedProjectionPlane, other_resolution) {
+        const ProjectionPlane runtime(320, 200, 90);
+        const FixedProjectionPlane<320, 200, 90> fixed;
+
+        ASSERT_EQ(runtime.distance_to_POV, fixed.distance_to_POV);
+        ASSERT_EQ(runtime.column_angles, fixed.column_angles);
+    }
+
+    TEST(FixedProjectionPlane, project_objects__same_picture) {
+        std::stringstream level;
+        level <<
+            "x 10\n"
+            "z 8\n"
+            "cell_size 64\n"
+            "##########\n"
+            "#...#..E.#\n"
+            "#.#...#..#\n"
+            "#....P...#\n"
+            "#..#..#.##\n"
+            "#.#E.....#\n"
+            "#...##..E#\n"
+            "##########\n"
+            "player_start_orientation_rad 0\n"
+            "player_ammo 1\n";
+        World w = World::load(level);
+        ProjectionPlane runtime(640, 480, 60);
+        KioskPlane fixed;
+
+        for (float orientation = 0; orientation < 6.28f; orientation += 0.2f) {
+            w.player.orientation = orientation;
+            MockCanvas expected;
+            MockCanvas result;
+
+            runtime.project_objects(w, expected);
+            fixed.project_objects(w, result);
+
+            ASSERT_EQ(expected.column_calls, result.column_calls);
+            ASSERT_EQ(expected.top_row_calls, result.top_row_calls);
+            ASSERT_EQ(expected.height_calls, result.height_calls);
+            ASSERT_EQ(expected.texture_offset_calls, result.texture_offset_calls);
+            ASSERT_EQ(expected.texture_calls, result.texture_calls);
+        }
+    }
+}
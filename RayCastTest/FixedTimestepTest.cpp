@@ -0,0 +1,72 @@
+#include "pch.h"
+
+#include "FixedTimestep.h"
+
+namespace rc {
+
+    /** A power of 2 fraction of second, the sums are exact. */
+    constexpr float STEP = 1.0f / 64;
+
+    TEST(FixedTimestep, creation__bad_parameters) {
+        ASSERT_ANY_THROW(FixedTimestep(0, 4));
+        ASSERT_ANY_THROW(FixedTimestep(-STEP, 4));
+        ASSERT_ANY_THROW(FixedTimestep(STEP, 0));
+    }
+
+    TEST(FixedTimestep, steps_for__fast_frames_pile_up) {
+        FixedTimestep simulation(STEP, 4);
+
+        ASSERT_EQ(0, simulation.steps_for(STEP / 2));
+        ASSERT_FLOAT_EQ(0.5f, simulation.interpolation());
+        ASSERT_EQ(1, simulation.steps_for(STEP / 2));
+        ASSERT_FLOAT_EQ(0, simulation.interpolation());
+    }
+
+    TEST(FixedTimestep, steps_for__slow_frame_many_steps) {
+        FixedTimestep simulation(STEP, 4);
+
+        ASSERT_EQ(3, simulation.steps_for(STEP * 3.25f));
+        ASSERT_FLOAT_EQ(0.25f, simulation.interpolation());
+    }
+
+    TEST(FixedTimestep, steps_for__same_steps_at_any_frame_rate) {
+        FixedTimestep at_60_fps(STEP, 4);
+        FixedTimestep at_25_fps(STEP, 4);
+
+        uint32_t steps_at_60 = 0;
+        for (int frame = 0; frame < 60; ++frame)
+            steps_at_60 += at_60_fps.steps_for(1.0f / 60);
+
+        uint32_t steps_at_25 = 0;
+        for (int frame = 0; frame < 25; ++frame)
+            steps_at_25 += at_25_fps.steps_for(1.0f / 25);
+
+        ASSERT_NEAR(64, steps_at_60, 1);  // The float sum of 1/60 may leave the last step for the next frame.
+        ASSERT_NEAR(64, steps_at_25, 1);
+    }
+
+    TEST(FixedTimestep, steps_for__long_frame_limited) {
+        FixedTimestep simulation(STEP, 4);
+
+        ASSERT_EQ(4, simulation.steps_for(STEP * 10.5f));
+        ASSERT_FLOAT_EQ(0.5f, simulation.interpolation());  // The fraction survives, the extra steps are lost.
+        ASSERT_EQ(0, simulation.steps_for(0));
+    }
+
+    TEST(FixedTimestep, steps_for__negative_time_ignored) {
+        FixedTimestep simulation(STEP, 4);
+
+        ASSERT_EQ(0, simulation.steps_for(-1));
+        ASSERT_FLOAT_EQ(0, simulation.interpolation());
+    }
+
+    TEST(FixedTimestep, reset) {
+        FixedTimestep simulation(STEP, 4);
+        simulation.steps_for(STEP * 0.75f);
+
+        simulation.reset();
+
+        ASSERT_FLOAT_EQ(0, simulation.interpolation());
+        ASSERT_EQ(0, simulation.steps_for(STEP * 0.5f));
+    }
+}
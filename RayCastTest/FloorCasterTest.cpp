@@ -0,0 +1,89 @@
+#include "pch.h"
+
+#include "FloorCaster.h"
+
+#include <vector>
+
+#include "Camera.h"
+#include "ProjectionPlane.h"
+#include "Shading.h"
+#include "Texture.h"
+
+namespace rc {
+
+    /** 4 * 4 texels, each with its own color: the index of the texel, plus the tag. */
+    static ShadedTexture numbered_texture(const uint32_t tag) {
+        std::vector<uint32_t> pixels;
+        for (uint32_t i = 0; i < 16; ++i)
+            pixels.push_back(0xFF000000 | tag | i);
+        return ShadedTexture(Texture(4, 4, pixels), LIGHT_LEVELS);
+    }
+
+    static uint32_t texel(const uint32_t x, const uint32_t y) {
+        return 0xFF000000 | (y * 4 + x);
+    }
+
+    constexpr uint32_t CEILING_TAG = 0x00FF0000;
+
+    TEST(FloorCaster, creation__texture_not_power_of_2) {
+        const ProjectionPlane plane(320, 200, 60);
+        const ShadedTexture bad(Texture(3, 3, std::vector<uint32_t>(9, 0)), 1);
+
+        ASSERT_ANY_THROW(FloorCaster(plane, 64, bad, numbered_texture(0)));
+        ASSERT_ANY_THROW(FloorCaster(plane, 64, numbered_texture(0), bad));
+    }
+
+    TEST(FloorCaster, cast__floor_below_ceiling_above) {
+        const ProjectionPlane plane(320, 200, 60);
+        const FloorCaster caster(plane, 64, numbered_texture(0), numbered_texture(CEILING_TAG));
+        std::vector<uint32_t> frame(320 * 200, 0);
+
+        caster.cast(Camera{ 100, 100, 0 }, frame.data(), 320);
+
+        ASSERT_EQ(0, frame.at(199 * 320 + 160) & CEILING_TAG);
+        ASSERT_EQ(CEILING_TAG, frame.at(0 * 320 + 160) & CEILING_TAG);
+        ASSERT_NE(0, frame.at(99 * 320 + 160) & CEILING_TAG);  // Darker, close to the horizon.
+        ASSERT_EQ(0, frame.at(100 * 320 + 160) & CEILING_TAG);
+    }
+
+    /** The bottom row is 32 * 278 / 99.5 (about 89.4) units ahead of the player.
+    The texels are 16 units wide (4 per 64 units cell). */
+    TEST(FloorCaster, cast__texture_coordinates) {
+        const ProjectionPlane plane(322, 200, 60);  // Not a multiple of 4, there is a column after the vector loop.
+        const FloorCaster caster(plane, 64, numbered_texture(0), numbered_texture(CEILING_TAG));
+        std::vector<uint32_t> frame(322 * 200, 0);
+
+        caster.cast(Camera{ 100, 100, 0 }, frame.data(), 322);
+
+        const uint32_t* bottom_row = frame.data() + 199 * 322;
+        ASSERT_EQ(texel(3, 2), bottom_row[161]);  // Straight ahead: 189.4, 100.
+        ASSERT_EQ(texel(3, 3), bottom_row[0]);  // 30 degrees on the left: 189.4, 48.4.
+        ASSERT_EQ(texel(3, 1), bottom_row[321]);  // Almost 30 on the right: 189.4, 151.2.
+    }
+
+    TEST(FloorCaster, cast__far_rows_darker) {
+        const ProjectionPlane plane(320, 200, 60);
+        const ShadedTexture white(Texture(1, 1, { 0xFFFFFFFF }), LIGHT_LEVELS);
+        const FloorCaster caster(plane, 64, white, white);
+        std::vector<uint32_t> frame(320 * 200, 0);
+
+        caster.cast(Camera{ 100, 100, 0 }, frame.data(), 320);
+
+        ASSERT_EQ(0xFFFFFFFF, frame.at(199 * 320));
+        ASSERT_EQ(Colormap(LIGHT_LEVELS - 1).shade(0xFFFFFFFF), frame.at(100 * 320));
+    }
+
+    /** 5 degrees over 7680 columns: the plane is further than 65535 pixels.
+    Only 8 columns are cast, stretched to the 7680 of the display. */
+    TEST(FloorCaster, cast__distance_beyond_16_bits) {
+        const ProjectionPlane plane(8, 4320, 5, 7680);
+        const ShadedTexture white(Texture(1, 1, { 0xFFFFFFFF }), LIGHT_LEVELS);
+        const FloorCaster caster(plane, 64, white, white);
+        std::vector<uint32_t> frame(8 * 4320, 0);
+
+        caster.cast(Camera{ 100, 100, 0 }, frame.data(), 8);
+
+        const float bottom_row_distance = 32.0f * 87950 / 2159.5f;  // About 1303 units.
+        ASSERT_EQ(Colormap(light_level(bottom_row_distance)).shade(0xFFFFFFFF), frame.at(4319 * 8));
+    }
+}
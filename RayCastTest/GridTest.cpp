@@ -125,6 +125,41 @@ namespace rc {
         ASSERT_FLOAT_EQ(32, hit.z);
     }
 
+    TEST(Grid, cast_ray__face_and_cell) {
+        Grid g(3, 3, 64);
+        g.build_wall(2, 1);
+        g.build_wall(1, 0);
+
+        const RayHit right = g.cast_ray(Ray(96, 96, 0));
+        ASSERT_EQ(WallFace::LEFT, right.face);
+        ASSERT_EQ(2, right.cell_x);
+        ASSERT_EQ(1, right.cell_z);
+
+        const RayHit down = g.cast_ray(Ray(96, 96, 3 * PI / 2));
+        ASSERT_EQ(WallFace::TOP, down.face);
+        ASSERT_EQ(1, down.cell_x);
+        ASSERT_EQ(0, down.cell_z);
+    }
+
+    TEST(Grid, cast_ray__beyond_max_distance) {
+        Grid g(10, 1, 64);
+        g.build_wall(9, 0);
+        const Ray r(32, 32, 0);
+
+        ASSERT_TRUE(g.cast_ray(r, 500).no_hit());
+        ASSERT_FLOAT_EQ(576, g.cast_ray(r, 600).x);
+        ASSERT_FLOAT_EQ(576, g.cast_ray(r).x);
+    }
+
+    TEST(Grid, cast_ray__max_distance_diagonal) {
+        Grid g(10, 10, 64);
+        g.build_wall(5, 5);
+        const Ray r(32, 32, PI / 4);  // Hits the corner at (320, 320), 407 away.
+
+        ASSERT_TRUE(g.cast_ray(r, 400).no_hit());
+        ASSERT_TRUE(g.cast_ray(r, 410).really_hit());
+    }
+
     TEST(Grid, cast_ray__horizontal_ray_going_left ) {
         Grid g(2, 1, 64);
         g.build_wall(0, 0);
@@ -228,7 +263,7 @@ namespace rc {
 
         RayHit hit = g.cast_ray(r);
 
-        ASSERT_FLOAT_EQ(63.999947f, hit.x);  // "Almost 64", due to the epsilon used to fudge the column/row.
+        ASSERT_FLOAT_EQ(63.999901f, hit.x);  // "Almost 64", due to the epsilon used to fudge the column/row.
         ASSERT_FLOAT_EQ(64, hit.z);
     }
 
@@ -0,0 +1,102 @@
+#include "pch.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "Camera.h"
+#include "FloorCaster.h"
+#include "ProjectionPlane.h"
+#include "Shading.h"
+#include "SoftwareCanvas.h"
+#include "Texture.h"
+#include "World.h"
+
+namespace rc {
+
+    /** Frame times at the sizes of the big displays. Disabled, they take seconds and they only print numbers:
+    run them with --gtest_also_run_disabled_tests --gtest_filter=HighResolutionBenchmark.* on a release build. */
+
+    static World benchmark_level() {
+        std::stringstream level;
+        level <<
+            "x 10\n"
+            "z 8\n"
+            "cell_size 64\n"
+            "##########\n"
+            "#...#..E.#\n"
+            "#.#...#..#\n"
+            "#....P...#\n"
+            "#..#..#.##\n"
+            "#.#E.....#\n"
+            "#...##..E#\n"
+            "##########\n"
+            "player_start_orientation_rad 0\n"
+            "player_ammo 1\n";
+        return World::load(level);
+    }
+
+    static ShadedTexture plain_texture(const uint32_t argb) {
+        return ShadedTexture(Texture(64, 64, std::vector<uint32_t>(64 * 64, argb)), LIGHT_LEVELS);
+    }
+
+    static double milliseconds_since(const std::chrono::steady_clock::time_point& start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /** Average over some frames of the wall and sprite pass (prepare), of the drawing and of the floor. */
+    static void measure_frames(const uint16_t columns, const uint16_t rows, const float FOV_degrees) {
+        constexpr int frames = 5;
+        const World w = benchmark_level();
+        ProjectionPlane plane(columns, rows, FOV_degrees);
+        plane.wall_drawing = ProjectionPlane::WallDrawing::SPANS;
+        const FloorCaster floor(plane, w.map.cell_size, plain_texture(0xFF404040), plain_texture(0xFF808080));
+
+        SoftwareCanvas canvas(columns, rows);
+        canvas.set_texture(TextureIndex::WALL, plain_texture(0xFFC0C0C0));
+        canvas.set_texture(TextureIndex::ENEMY, plain_texture(0xFFFF0000));
+        canvas.set_texture(TextureIndex::EXIT, plain_texture(0xFF00FF00));
+
+        double floor_ms = 0;
+        double prepare_ms = 0;
+        double draw_ms = 0;
+        Camera camera = w.player.camera();
+
+        for (int frame = 0; frame < frames; ++frame) {
+            camera.orientation += BinaryAngle(0.05f);
+
+            auto start = std::chrono::steady_clock::now();
+            floor.cast(camera, canvas.pixels.data(), columns);
+            floor_ms += milliseconds_since(start);
+
+            start = std::chrono::steady_clock::now();
+            plane.prepare(w, camera);
+            prepare_ms += milliseconds_since(start);
+
+            start = std::chrono::steady_clock::now();
+            plane.draw(canvas);
+            draw_ms += milliseconds_since(start);
+        }
+
+        std::cout << columns << "x" << rows << ", FOV " << FOV_degrees << ": "
+            << "floor " << floor_ms / frames << " ms, "
+            << "prepare " << prepare_ms / frames << " ms, "
+            << "draw " << draw_ms / frames << " ms per frame." << std::endl;
+    }
+
+    TEST(HighResolutionBenchmark, DISABLED_frame__4K) {
+        measure_frames(3840, 2160, 60);
+        measure_frames(3840, 2160, 170);
+    }
+
+    TEST(HighResolutionBenchmark, DISABLED_frame__8K) {
+        measure_frames(7680, 4320, 60);
+        measure_frames(7680, 4320, 170);
+    }
+
+    TEST(HighResolutionBenchmark, DISABLED_frame__ultra_wide) {
+        measure_frames(5120, 1440, 120);
+        measure_frames(7680, 2160, 170);
+    }
+}
@@ -309,4 +309,136 @@ namespace rc {
 
 		ASSERT_EQ(5, found_objects.size()); // Indices 3 to 7.
 	}
-}
\ No newline at end of file
+
+	static const auto accept_all = [](const RayHit&) { return true; };
+
+	TEST(kdTree, closest_hit__nothing) {
+		KdTree tree;
+		tree.objects.emplace_back(100, 100, 64, 1, TextureIndex::ENEMY);
+		tree.build(10, 1);
+
+		const RayHit hit = tree.closest_hit(Ray(0, 0, PI), 1000, accept_all);
+
+		ASSERT_TRUE(hit.no_hit());
+	}
+
+	TEST(kdTree, closest_hit__front_to_back_across_the_split) {
+		KdTree tree;
+		tree.objects.emplace_back(-100, 0, 64, 1, TextureIndex::ENEMY);
+		tree.objects.emplace_back(+100, 0, 64, 2, TextureIndex::ENEMY);
+		tree.build(10, 1);
+
+		const RayHit from_high = tree.closest_hit(Ray(200, 0, PI), 1000, accept_all);
+		const RayHit from_low = tree.closest_hit(Ray(-200, 0, 0), 1000, accept_all);
+
+		ASSERT_EQ(2, from_high.hit_object_id);
+		ASSERT_FLOAT_EQ(100, from_high.distance);
+		ASSERT_EQ(1, from_low.hit_object_id);
+		ASSERT_FLOAT_EQ(100, from_low.distance);
+	}
+
+	TEST(kdTree, closest_hit__accept_skips_to_the_next) {
+		KdTree tree;
+		tree.objects.emplace_back(-100, 0, 64, 1, TextureIndex::ENEMY);
+		tree.objects.emplace_back(+100, 0, 64, 2, TextureIndex::ENEMY);
+		tree.build(10, 1);
+
+		const RayHit hit = tree.closest_hit(Ray(200, 0, PI), 1000,
+			[](const RayHit& h) { return h.hit_object_id != 2; });
+
+		ASSERT_EQ(1, hit.hit_object_id);
+		ASSERT_FLOAT_EQ(300, hit.distance);
+	}
+
+	TEST(kdTree, closest_hit__beyond_cutoff) {
+		KdTree tree;
+		tree.objects.emplace_back(-100, 0, 64, 1, TextureIndex::ENEMY);
+		tree.objects.emplace_back(+100, 0, 64, 2, TextureIndex::ENEMY);
+		tree.build(10, 1);
+
+		const RayHit hit = tree.closest_hit(Ray(200, 0, PI), 99, accept_all);
+
+		ASSERT_TRUE(hit.no_hit());
+	}
+
+	TEST(kdTree, closest_hit__ignores_inactive) {
+		KdTree tree;
+		tree.objects.emplace_back(-100, 0, 64, 1, TextureIndex::ENEMY);
+		tree.objects.emplace_back(+100, 0, 64, 2, TextureIndex::ENEMY);
+		tree.objects.back().active = false;
+		tree.build(10, 1);
+
+		const RayHit hit = tree.closest_hit(Ray(200, 0, PI), 1000, accept_all);
+
+		ASSERT_EQ(1, hit.hit_object_id);
+	}
+
+	TEST(kdTree, closest_hit__skips_invisible) {
+		KdTree tree;
+		tree.objects.emplace_back(-100, 0, 64, 1, TextureIndex::ENEMY);
+		tree.objects.emplace_back(+100, 0, 64, 2, TextureIndex::ENEMY);
+		tree.build(10, 1);
+		ObjectBits visible;
+		visible.set(0);
+
+		const RayHit hit = tree.closest_hit(Ray(200, 0, PI), 1000, visible, accept_all);
+
+		ASSERT_EQ(1, hit.hit_object_id);
+	}
+
+	TEST(kdTree, Build__subtree_objects) {
+		KdTree tree;
+		tree.objects.emplace_back(-100, 0, 64, 1, TextureIndex::ENEMY);
+		tree.objects.emplace_back(+100, 0, 64, 2, TextureIndex::ENEMY);
+		tree.build(10, 1);
+
+		ASSERT_EQ(2, tree.root.subtree_objects.count());
+		ASSERT_TRUE(tree.root.low->subtree_objects[0]);
+		ASSERT_FALSE(tree.root.low->subtree_objects[1]);
+	}
+
+	TEST(kdTree, intersect__nothing_visible) {
+		KdTree tree;
+		tree.objects.emplace_back(-100, 0, 64, 1, TextureIndex::ENEMY);
+		tree.objects.emplace_back(+100, 0, 64, 2, TextureIndex::ENEMY);
+		tree.build(10, 1);
+
+		ASSERT_EQ(2, tree.intersect(Ray(200, 0, PI), 1000).size());
+		ASSERT_TRUE(tree.intersect(Ray(200, 0, PI), 1000, ObjectBits()).empty());
+	}
+
+	TEST(kdTree, closest_hit__diagonal_in_a_very_complicated_tree) {
+		KdTree tree;
+		tree.objects.emplace_back(70, 0, 32, 1, TextureIndex::ENEMY);
+		tree.objects.emplace_back(110, 0, 32, 2, TextureIndex::ENEMY);
+		tree.objects.emplace_back(140, 10, 32, 3, TextureIndex::ENEMY);
+		tree.objects.emplace_back(110, 60, 32, 4, TextureIndex::ENEMY);
+		tree.objects.emplace_back(70, 65, 32, 5, TextureIndex::ENEMY);
+		tree.objects.emplace_back(130, 100, 32, 6, TextureIndex::ENEMY);
+		tree.objects.emplace_back(70, 200, 32, 7, TextureIndex::ENEMY);
+		tree.objects.emplace_back(125, 200, 32, 8, TextureIndex::ENEMY);
+		tree.build(10, 2);
+
+		// Rays in all the directions, from inside and outside the tree. Must find the same as the brute force search.
+		const WorldCoordinate origins[] = { {100, 100}, {0, 0}, {160, 260}, {200, 30} };
+		for (const WorldCoordinate& origin : origins)
+			for (float alpha = 0; alpha < 2 * PI; alpha += PI / 90) {
+				const Ray r(origin.x, origin.z, alpha);
+
+				RayHit brute_force;
+				for (const Sprite& s : tree.objects) {
+					const RayHit h = s.intersection(r);
+					if (h.really_hit() && (brute_force.no_hit() || h.distance < brute_force.distance))
+						brute_force = h;
+				}
+
+				const RayHit hit = tree.closest_hit(r, 1000, accept_all);
+
+				ASSERT_EQ(brute_force.really_hit(), hit.really_hit());
+				if (hit.really_hit()) {
+					ASSERT_EQ(brute_force.hit_object_id, hit.hit_object_id);
+					ASSERT_FLOAT_EQ(brute_force.distance, hit.distance);
+				}
+			}
+	}
+}
@@ -7,14 +7,17 @@ namespace rc {
 
     class MockCanvas : public Canvas {
     public:
-        void draw_slice(const uint16_t column, const int16_t top_row, const uint16_t height, const uint16_t texture_offset, const TextureIndex what_to_draw) final {
+        void draw_slice(const uint16_t column, const SliceProjection& slice, const uint16_t texture_offset, const TextureIndex what_to_draw) final {
             column_calls.push_back(column);
-            top_row_calls.push_back(top_row);
-            height_calls.push_back(height);
+            top_row_calls.push_back(slice.top_row);
+            height_calls.push_back(slice.height);
+            texture_top_calls.push_back(slice.texture_top);
+            texture_offset_calls.push_back(texture_offset);
+            texture_calls.push_back(what_to_draw);
         }
 
-        bool transparent_pixel(const uint8_t x, const uint8_t y, const TextureIndex image) const final {
-            return false;
+        void draw_span(const WallSpan& span, const TextureIndex what_to_draw) final {
+            span_calls.push_back(span);
         }
 
         void draw_text(const std::string& text, uint16_t column, const uint16_t row, const uint8_t font_size) final {
@@ -28,6 +31,10 @@ namespace rc {
         std::vector<uint16_t> column_calls;
         std::vector<uint16_t> top_row_calls;
         std::vector<uint16_t> height_calls;
+        std::vector<float> texture_top_calls;
+        std::vector<uint16_t> texture_offset_calls;
+        std::vector<TextureIndex> texture_calls;
+        std::vector<WallSpan> span_calls;
 
         std::string last_drawn_string;
     };
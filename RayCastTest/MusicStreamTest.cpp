@@ -0,0 +1,105 @@
+#include "pch.h"
+
+#include "MusicStream.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "TestWav.h"
+
+namespace rc {
+
+    static std::vector<int16_t> take(MusicStream& stream, const uint32_t frames) {
+        std::vector<int16_t> output(frames * 2, 1234);
+        stream.take(output.data(), frames);
+        return output;
+    }
+
+    TEST(MusicStream, creation__fills_the_ring) {
+        const MusicStream stream(wav_stream({ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 }, 1), 4);
+
+        ASSERT_EQ(4, stream.buffered_frames());
+        ASSERT_EQ(44100, stream.frequency());
+    }
+
+    TEST(MusicStream, creation__no_frames) {
+        ASSERT_ANY_THROW(MusicStream(wav_stream({}, 2), 4));
+    }
+
+    TEST(MusicStream, creation__not_a_wav) {
+        ASSERT_ANY_THROW(MusicStream(std::make_unique<std::stringstream>("not a wav file"), 4));
+    }
+
+    TEST(MusicStream, take__same_frames_of_the_file) {
+        MusicStream stream(wav_stream({ 1, -1, 2, -2, 3, -3 }, 2), 8);
+
+        ASSERT_EQ(std::vector<int16_t>({ 1, -1, 2, -2 }), take(stream, 2));
+        ASSERT_EQ(6, stream.buffered_frames());  // The ring was filled looping on the file.
+    }
+
+    TEST(MusicStream, take__silence_when_not_refilled) {
+        MusicStream stream(wav_stream({ 1, 2, 3, 4, 5, 6 }, 1), 2);
+        std::vector<int16_t> output(8, 1234);
+
+        ASSERT_EQ(2, stream.take(output.data(), 4));
+
+        ASSERT_EQ(std::vector<int16_t>({ 1, 1, 2, 2, 0, 0, 0, 0 }), output);
+    }
+
+    TEST(MusicStream, refill__loops_at_the_end_of_the_file) {
+        MusicStream stream(wav_stream({ 1, 2, 3 }, 1), 2);
+        std::vector<int16_t> played;
+
+        for (int i = 0; i < 4; ++i) {
+            const std::vector<int16_t> frames = take(stream, 2);
+            played.insert(played.end(), frames.begin(), frames.end());
+            stream.refill();
+        }
+
+        ASSERT_EQ(std::vector<int16_t>({ 1, 1, 2, 2, 3, 3, 1, 1, 2, 2, 3, 3, 1, 1, 2, 2 }), played);
+    }
+
+    TEST(MusicStream, refill__no_more_than_the_ring) {
+        MusicStream stream(wav_stream(std::vector<int16_t>(1000, 7), 2), 16);
+        take(stream, 5);
+
+        ASSERT_EQ(5, stream.refill());
+        ASSERT_EQ(0, stream.refill());
+        ASSERT_EQ(16, stream.buffered_frames());
+    }
+
+    TEST(MusicStream, take__while_refilled_by_another_thread) {
+        // A ramp that wraps around in the file and many times around the ring: any frame lost or repeated shows.
+        std::vector<int16_t> ramp;
+        for (int16_t i = 0; i < 1000; ++i) {
+            ramp.push_back(i);
+            ramp.push_back(-i);
+        }
+        MusicStream stream(wav_stream(ramp, 2), 64);
+        constexpr uint32_t frames_to_play = 20000;
+
+        std::atomic<bool> playing(true);
+        std::thread refill_thread([&stream, &playing] {
+            while (playing)
+                if (stream.refill() == 0)
+                    std::this_thread::yield();
+        });
+
+        std::vector<int16_t> played;
+        std::vector<int16_t> block(2 * 10);
+        while (played.size() < frames_to_play * 2) {
+            const uint32_t got = stream.take(block.data(), 10);
+            if (got == 0)
+                std::this_thread::yield();
+            played.insert(played.end(), block.begin(), block.begin() + got * 2);
+        }
+        playing = false;
+        refill_thread.join();
+
+        bool same_as_file = true;
+        for (uint32_t frame = 0; frame < frames_to_play; ++frame)
+            same_as_file = same_as_file && played[frame * 2] == (int16_t) (frame % 1000) && played[frame * 2 + 1] == -(int16_t) (frame % 1000);
+        ASSERT_TRUE(same_as_file);
+    }
+}
@@ -0,0 +1,105 @@
+#include "pch.h"
+
+#include "Objects.h"
+
+#include <string>
+
+#include "PI.h"
+#include "Ray.h"
+
+namespace rc {
+
+    static Objects enemy_grid(const uint8_t side) {
+        Objects o;
+        uint8_t id = 0;
+        for (uint8_t x = 0; x < side; ++x)
+            for (uint8_t z = 0; z < side; ++z) {
+                o.enemies.objects.emplace_back(x * 200.0f + 32, z * 200.0f + 32, 64, id, TextureIndex::ENEMY);
+                ++id;
+            }
+        return o;
+    }
+
+    static bool accept_all(const RayHit&) {
+        return true;
+    }
+
+    TEST(Objects, prepare_broad_phase__few_enemies_linear) {
+        Objects o = enemy_grid(2);
+
+        o.prepare_broad_phase();
+
+        ASSERT_EQ(BroadPhase::LINEAR, o.broad_phase.strategy);
+        ASSERT_FLOAT_EQ(4, o.linear_cost);
+    }
+
+    TEST(Objects, prepare_broad_phase__many_enemies_tree) {
+        Objects o = enemy_grid(15);
+
+        o.prepare_broad_phase();
+
+        ASSERT_EQ(BroadPhase::KD_TREE, o.broad_phase.strategy);
+        ASSERT_LT(o.broad_phase_cost, o.linear_cost);
+        ASSERT_LT(0, o.broad_phase.max_depth);
+    }
+
+    TEST(Objects, prepare_broad_phase__no_enemies) {
+        Objects o;
+
+        o.prepare_broad_phase();
+
+        ASSERT_EQ(BroadPhase::LINEAR, o.broad_phase.strategy);
+        ASSERT_TRUE(o.closest_enemy(Ray(0, 0, 0), 1000, accept_all).no_hit());
+    }
+
+    TEST(Objects, prepare_broad_phase__forced) {
+        Objects o = enemy_grid(2);
+
+        o.prepare_broad_phase(BroadPhaseSettings{ BroadPhase::KD_TREE, 3, 1 });
+
+        ASSERT_EQ(BroadPhase::KD_TREE, o.broad_phase.strategy);
+        ASSERT_EQ(3, o.broad_phase.max_depth);
+        ASSERT_NE(nullptr, o.enemies.root.low);
+        ASSERT_ANY_THROW(o.prepare_broad_phase(BroadPhaseSettings{ BroadPhase::KD_TREE, 0, 1 }));
+    }
+
+    TEST(Objects, broad_phase_report) {
+        Objects o = enemy_grid(2);
+        o.prepare_broad_phase(BroadPhaseSettings{ BroadPhase::KD_TREE, 3, 1 });
+
+        const std::string report = o.broad_phase_report();
+
+        ASSERT_NE(std::string::npos, report.find("4 enemies"));
+        ASSERT_NE(std::string::npos, report.find("KdTree, depth 3, leaves of 1"));
+    }
+
+    TEST(Objects, closest_enemy__same_for_all_broad_phases) {
+        Objects linear = enemy_grid(6);
+        Objects tree = enemy_grid(6);
+        linear.prepare_broad_phase(BroadPhaseSettings{ BroadPhase::LINEAR, 0, 0 });
+        tree.prepare_broad_phase(BroadPhaseSettings{ BroadPhase::KD_TREE, 6, 2 });
+
+        for (float angle = 0.05f; angle < 2 * PI; angle += 0.1f) {
+            const Ray r(500, 520, angle);
+            const RayHit expected = linear.closest_enemy(r, 2000, accept_all);
+            const RayHit result = tree.closest_enemy(r, 2000, accept_all);
+
+            ASSERT_EQ(expected.really_hit(), result.really_hit());
+            if (expected.really_hit()) {
+                ASSERT_EQ(expected.hit_object_id, result.hit_object_id);
+            }
+        }
+    }
+
+    TEST(Objects, all_intersections__linear) {
+        Objects o = enemy_grid(3);
+        o.prepare_broad_phase(BroadPhaseSettings{ BroadPhase::LINEAR, 0, 0 });
+        RayHit far_wall;
+        far_wall.distance = 10000;
+
+        const std::vector<RayHit> hits = o.all_intersections(Ray(0, 32, 0), far_wall, (uint8_t) TextureIndex::ENEMY);
+
+        ASSERT_EQ(3, hits.size());
+        ASSERT_GT(hits.front().distance, hits.back().distance);  // Farthest first.
+    }
+}
@@ -0,0 +1,113 @@
+#include "pch.h"
+
+#include "ParallelViews.h"
+
+#include <sstream>
+
+#include "MockInterface.h"
+#include "PI.h"
+
+namespace rc {
+
+    static World split_screen_level() {
+        std::stringstream level;
+        level <<
+            "x 10\n"
+            "z 8\n"
+            "cell_size 64\n"
+            "##########\n"
+            "#...#..E.#\n"
+            "#.#...#..#\n"
+            "#....P...#\n"
+            "#..#..#.##\n"
+            "#.#E.....#\n"
+            "#...##..E#\n"
+            "##########\n"
+            "player_start_orientation_rad 0\n"
+            "player_ammo 1\n";
+        return World::load(level);
+    }
+
+    /** Left and right halves of a 640x200 screen, and a rear-view mirror on top of the right one. */
+    static void expect_same_as_one_view_at_a_time(const uint8_t worker_threads) {
+        const World w = split_screen_level();
+        ProjectionPlane left(320, 200, 60);
+        ProjectionPlane right(320, 200, 60);
+        ProjectionPlane mirror(100, 40, 60);
+        right.wall_drawing = ProjectionPlane::WallDrawing::SPANS;
+        ProjectionPlane reference(320, 200, 60);
+        ProjectionPlane reference_mirror(100, 40, 60);
+
+        ParallelViews views(worker_threads);
+        views.views.push_back(View{ &left, Camera{ 330, 220, 0.5f }, 0, 0 });
+        views.views.push_back(View{ &right, Camera{ 200, 120, 2.0f }, 320, 0 });
+        views.views.push_back(View{ &mirror, Camera{ 200, 120, 2.0f + PI }, 430, 10 });
+
+        for (int frame = 0; frame < 20; ++frame) {
+            views.views[0].camera.orientation += BinaryAngle(0.1f);
+            views.views[1].camera.x += 2;
+            MockCanvas result;
+            MockCanvas expected;
+
+            views.project_objects(w, result);
+
+            Viewport<MockCanvas> left_viewport(expected, 0, 0, 200);
+            reference.project_objects(w, views.views[0].camera, left_viewport);
+            reference.wall_drawing = ProjectionPlane::WallDrawing::SPANS;
+            Viewport<MockCanvas> right_viewport(expected, 320, 0, 200);
+            reference.project_objects(w, views.views[1].camera, right_viewport);
+            reference.wall_drawing = ProjectionPlane::WallDrawing::SLICES;
+            Viewport<MockCanvas> mirror_viewport(expected, 430, 10, 40);
+            reference_mirror.project_objects(w, views.views[2].camera, mirror_viewport);
+
+            ASSERT_EQ(expected.column_calls, result.column_calls);
+            ASSERT_EQ(expected.top_row_calls, result.top_row_calls);
+            ASSERT_EQ(expected.height_calls, result.height_calls);
+            ASSERT_EQ(expected.texture_offset_calls, result.texture_offset_calls);
+            ASSERT_EQ(expected.texture_calls, result.texture_calls);
+        }
+    }
+
+    TEST(ParallelViews, project_objects__same_as_one_view_at_a_time) {
+        expect_same_as_one_view_at_a_time(3);
+    }
+
+    TEST(ParallelViews, project_objects__no_worker_threads) {
+        expect_same_as_one_view_at_a_time(0);
+    }
+
+    TEST(ParallelViews, project_objects__views_change_between_frames) {
+        const World w = split_screen_level();
+        std::vector<ProjectionPlane> planes(4, ProjectionPlane(160, 100, 60));
+        ProjectionPlane reference(160, 100, 60);
+        ParallelViews views(3);
+
+        for (int frame = 0; frame < 40; ++frame) {
+            // From 0 to 4 views, a different number every frame: the vector grows and shrinks.
+            views.views.clear();
+            for (int v = 0; v < (frame * 3) % 5; ++v)
+                views.views.push_back(View{ &planes[v], Camera{ 200.0f + 30 * v, 120, 0.3f * frame }, (uint16_t) (160 * v), 0 });
+            MockCanvas result;
+            MockCanvas expected;
+
+            views.project_objects(w, result);
+
+            for (const View& view : views.views) {
+                Viewport<MockCanvas> viewport(expected, view.left, view.top, 100);
+                reference.project_objects(w, view.camera, viewport);
+            }
+            ASSERT_EQ(expected.column_calls, result.column_calls);
+            ASSERT_EQ(expected.texture_calls, result.texture_calls);
+        }
+    }
+
+    TEST(ParallelViews, project_objects__no_views) {
+        const World w = split_screen_level();
+        ParallelViews views(2);
+        MockCanvas mc;
+
+        views.project_objects(w, mc);
+
+        ASSERT_TRUE(mc.column_calls.empty());
+    }
+}
@@ -10,76 +10,100 @@ namespace rc {
 
 	static const Grid empty_map(10, 10, 64);
 
+	/** A power of 2 fraction of second: the distances come out exact, 4.6875 units for a step. */
+	static constexpr float STEP = 1.0f / 64;
+
 	TEST(Player, advance__horizontal) {
 		Player p{ 0, 0, 0 };
 
 
-		p.advance(+1, empty_map);
-		ASSERT_FLOAT_EQ(5, p.x_position);
+		p.advance(+1, STEP, empty_map);
+		ASSERT_FLOAT_EQ(4.6875f, p.x_position);
 		ASSERT_FLOAT_EQ(0, p.z_position);
 	}
 
 	TEST(Player, advance__vertical) {
 		Player p{ 0, 0, PI / 2 };
 
-		p.advance(+1, empty_map);
-		ASSERT_FLOAT_EQ(5.0f, p.z_position);
-		ASSERT_FLOAT_EQ(-2.1855695e-07f, p.x_position);
+		p.advance(+1, STEP, empty_map);
+		ASSERT_FLOAT_EQ(4.6875f, p.z_position);
+		ASSERT_EQ(0, p.x_position);  // Exact, the binary angle is exactly PI / 2.
 	}
 
 	TEST(Player, advance__backward) {
-		Player p{ 5, 0, 0 };
+		Player p{ 4.6875f, 0, 0 };
 
-		p.advance(-1, empty_map);
+		p.advance(-1, STEP, empty_map);
 		ASSERT_FLOAT_EQ(0, p.x_position);
 		ASSERT_FLOAT_EQ(0, p.z_position);
 	}
 
 	TEST(Player, advance__reverse_orientation) {
-		Player p{ 5, 0, PI};
+		Player p{ 4.6875f, 0, PI};
 
-		p.advance(1, empty_map);
+		p.advance(1, STEP, empty_map);
 		ASSERT_FLOAT_EQ(0.0f, p.x_position);
-		ASSERT_FLOAT_EQ(-4.371139e-07f, p.z_position);
+		ASSERT_EQ(0, p.z_position);
 	}
 
 	TEST(Player, advance__reverse_orientation_backward) {
 		Player p{ 15, 0, PI };
 
-		p.advance(-1, empty_map);
-		ASSERT_FLOAT_EQ(20.0f, p.x_position);
-		ASSERT_FLOAT_EQ(4.371139e-07f, p.z_position);
+		p.advance(-1, STEP, empty_map);
+		ASSERT_FLOAT_EQ(19.6875f, p.x_position);
+		ASSERT_EQ(0, p.z_position);
 	}
 
 	TEST(Player, advance__diagonal) {
 		Player p{ 5, 0, 3 * PI / 4};
 
-		p.advance(1, empty_map);
-		ASSERT_FLOAT_EQ(1.4644661f, p.x_position);
-		ASSERT_FLOAT_EQ(3.5355339f, p.z_position);
+		p.advance(1, STEP, empty_map);
+		ASSERT_FLOAT_EQ(1.685437f, p.x_position);
+		ASSERT_FLOAT_EQ(3.314563f, p.z_position);
 	}
 
 	TEST(Player, advance__diagonal_reverse) {
 		Player p{ 10, 0, 3 * PI / 4 };
 
-		p.advance(-1, empty_map);
-		ASSERT_FLOAT_EQ(13.535534f, p.x_position);
-		ASSERT_FLOAT_EQ(-3.5355339f, p.z_position);
+		p.advance(-1, STEP, empty_map);
+		ASSERT_FLOAT_EQ(13.314563f, p.x_position);
+		ASSERT_FLOAT_EQ(-3.314563f, p.z_position);
+	}
+
+	TEST(Player, advance__distance_proportional_to_time) {
+		Player in_one_step{ 0, 0, 0 };
+		Player in_two_steps{ 0, 0, 0 };
+
+		in_one_step.advance(1, STEP, empty_map);
+		in_two_steps.advance(1, STEP / 2, empty_map);
+		in_two_steps.advance(1, STEP / 2, empty_map);
+
+		ASSERT_EQ(in_one_step.x_position, in_two_steps.x_position);
+		ASSERT_FLOAT_EQ(Player::ADVANCE_SPEED, in_one_step.x_position / STEP);
 	}
 
 
 	TEST(Player, turn__left) {
 		Player p{ 0, 0, 0 };
 
-		p.turn(1);
-		ASSERT_FLOAT_EQ(0.045000002f, p.orientation);
+		p.turn(1, STEP);
+		ASSERT_NEAR(0.0421875f, p.orientation.radians(), BinaryAngle::RESOLUTION_RADIANS);
 	}
 
 	TEST(Player, turn__right) {
 		Player p{ 0, 0, 0 };
 
-		p.turn(-1);
-		ASSERT_FLOAT_EQ(6.2831855f, p.orientation);
+		p.turn(-1, STEP);
+		ASSERT_NEAR(2 * PI - 0.0421875f, p.orientation.radians(), BinaryAngle::RESOLUTION_RADIANS);
+	}
+
+	TEST(Player, camera__changes_only_with_movement) {
+		Player p{ 10, 20, 1 };
+		const Camera before = p.camera();
+
+		ASSERT_EQ(before, p.camera());
+		p.turn(1, STEP);
+		ASSERT_NE(before, p.camera());
 	}
 
 	// TODO: test movement that hits walls.
@@ -89,11 +113,44 @@ namespace rc {
 		p.bullets_left = 1;
 
 		Objects no_one;
-		MockCanvas always_hit;
+		AlphaMasks always_hit;
 		MockSpeaker no_sound;
 		p.shoot(empty_map, no_one, always_hit, no_sound);
 		ASSERT_EQ(0, p.bullets_left);
 	}
 
-	// TODO: test bullets do not underflow, test it hits things, test it won't shoot without bullets...
+	TEST(Player, shoot_hits_the_closest_target) {
+		Player p{ 32, 32, 0 };
+		p.bullets_left = 1;
+
+		Objects targets;
+		targets.enemies.objects.emplace_back(400.0f, 32.0f, 64, 0, TextureIndex::ENEMY);
+		targets.enemies.objects.emplace_back(200.0f, 32.0f, 64, 1, TextureIndex::ENEMY);
+		targets.enemies.build(10, 1);
+		AlphaMasks always_hit;
+		MockSpeaker no_sound;
+		p.shoot(empty_map, targets, always_hit, no_sound);
+
+		ASSERT_EQ(1, p.kills);
+		ASSERT_TRUE(targets.enemies.objects.at(0).active);
+		ASSERT_FALSE(targets.enemies.objects.at(1).active);
+	}
+
+	TEST(Player, shoot_through_transparent_pixels) {
+		Player p{ 32, 32, 0 };
+		p.bullets_left = 1;
+
+		Objects targets;
+		targets.enemies.objects.emplace_back(200.0f, 32.0f, 64, 0, TextureIndex::ENEMY);
+		targets.enemies.build(10, 1);
+		AlphaMasks see_through;
+		see_through.set(TextureIndex::ENEMY, AlphaMask(Texture(64, 64, std::vector<uint32_t>(64 * 64, 0))));
+		MockSpeaker no_sound;
+		p.shoot(empty_map, targets, see_through, no_sound);
+
+		ASSERT_EQ(0, p.kills);
+		ASSERT_TRUE(targets.enemies.objects.at(0).active);
+	}
+
+	// TODO: test bullets do not underflow, test it won't shoot without bullets...
 }
\ No newline at end of file
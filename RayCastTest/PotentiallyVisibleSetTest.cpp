@@ -0,0 +1,181 @@
+#include "pch.h"
+
+#include "PotentiallyVisibleSet.h"
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Grid.h"
+#include "Objects.h"
+#include "World.h"
+
+namespace rc {
+
+    /** Two rooms, separated by a wall with a door on the far left. */
+    static Grid two_rooms() {
+        Grid g(8, 7, 64);
+        for (uint8_t x = 1; x < 8; ++x)
+            g.build_wall(x, 3);
+        return g;
+    }
+
+    /** A small enemy in the middle of the cell of each point: it covers that cell only. */
+    static Objects enemies_at(const std::vector<std::pair<float, float>>& points, const uint8_t cell_size = 64) {
+        Objects o;
+        for (const auto& point : points) {
+            const float x = std::floor(point.first / cell_size) * cell_size + cell_size / 2;
+            const float z = std::floor(point.second / cell_size) * cell_size + cell_size / 2;
+            o.enemies.objects.emplace_back(x, z, 16, (uint8_t) o.enemies.objects.size(), TextureIndex::ENEMY);
+        }
+        return o;
+    }
+
+    TEST(PotentiallyVisibleSet, empty__everything_visible) {
+        const PotentiallyVisibleSet pvs;
+
+        ASSERT_TRUE(pvs.empty());
+        GridCoordinate from;
+        from.x = 1; from.z = 1;
+        ASSERT_TRUE(pvs.objects_visible_from(from).enemies.all());
+    }
+
+    TEST(PotentiallyVisibleSet, objects_visible_from__open_space) {
+        const Grid g(8, 8, 64);
+        const PotentiallyVisibleSet pvs(g, enemies_at({ { 500, 500 }, { 10, 500 } }));
+
+        ASSERT_TRUE(pvs.objects_visible_from(g.cell_of(10, 10)).enemies[0]);
+        ASSERT_TRUE(pvs.objects_visible_from(g.cell_of(500, 10)).enemies[1]);
+    }
+
+    TEST(PotentiallyVisibleSet, objects_visible_from__behind_the_wall) {
+        const Grid g = two_rooms();
+        const PotentiallyVisibleSet pvs(g, enemies_at({
+            { 7 * 64 + 32, 6 * 64 + 32 }, { 7 * 64 + 32, 32 }, { 32, 6 * 64 + 32 }, { 3 * 64 + 32, 5 * 64 + 32 } }));
+
+        // From the far right of a room, the other room can not be seen through the door on the left.
+        ASSERT_FALSE(pvs.objects_visible_from(g.cell_of(7 * 64 + 32, 32)).enemies[0]);
+        ASSERT_FALSE(pvs.objects_visible_from(g.cell_of(7 * 64 + 32, 6 * 64 + 32)).enemies[1]);
+
+        // Through the door.
+        ASSERT_TRUE(pvs.objects_visible_from(g.cell_of(32, 32)).enemies[2]);
+        ASSERT_TRUE(pvs.objects_visible_from(g.cell_of(32, 2 * 64 + 32)).enemies[3]);
+    }
+
+    TEST(PotentiallyVisibleSet, objects_visible_from__sprite_in_the_wall) {
+        const Grid g = two_rooms();
+        const PotentiallyVisibleSet pvs(g, enemies_at({ { 4 * 64 + 32, 3 * 64 + 32 } }));
+
+        ASSERT_TRUE(pvs.objects_visible_from(g.cell_of(7 * 64 + 32, 32)).enemies[0]);
+    }
+
+    TEST(PotentiallyVisibleSet, objects_visible_from) {
+        const Grid g = two_rooms();
+        Objects o;
+        o.enemies.objects.emplace_back(7 * 64 + 32, 6 * 64 + 32, 64, 0, TextureIndex::ENEMY);  // Other room.
+        o.enemies.objects.emplace_back(4 * 64 + 32, 2 * 64 + 32, 64, 1, TextureIndex::ENEMY);  // Same room.
+        o.exits.emplace_back(32, 6 * 64 + 32, 64, 2, TextureIndex::EXIT);  // Other room, by the door.
+        const PotentiallyVisibleSet pvs(g, o);
+
+        const VisibleObjects& visible = pvs.objects_visible_from(g.cell_of(7 * 64 + 32, 32));
+
+        ASSERT_FALSE(visible.enemies[0]);
+        ASSERT_TRUE(visible.enemies[1]);
+        ASSERT_FALSE(visible.exits[0]);
+        ASSERT_TRUE(pvs.objects_visible_from(g.cell_of(32, 32)).exits[0]);
+    }
+
+    TEST(PotentiallyVisibleSet, creation__big_grid_few_objects) {
+        const Grid g(255, 255, 64);
+
+        const PotentiallyVisibleSet pvs(g, enemies_at({ { 16000, 16000 } }));
+
+        ASSERT_FALSE(pvs.empty());
+        ASSERT_TRUE(pvs.objects_visible_from(g.cell_of(8000, 8000)).enemies[0]);
+    }
+
+    TEST(PotentiallyVisibleSet, creation__too_many_cell_pairs) {
+        const Grid g(255, 255, 64);
+        std::vector<std::pair<float, float>> points;
+        for (int i = 0; i < 3; ++i)  // 3 cells with enemies, from 65025 empty cells, lines up to 510 cells.
+            points.emplace_back(100.0f + 64 * i, 100.0f);
+
+        const PotentiallyVisibleSet pvs(g, enemies_at(points));
+
+        ASSERT_TRUE(pvs.empty());
+        ASSERT_TRUE(pvs.objects_visible_from(g.cell_of(100, 100)).enemies.all());
+        ASSERT_NE(std::string::npos, pvs.report().find("skipped"));
+    }
+
+    /** Line from a point to the other, checked in small steps against the real walls. */
+    static bool clear_line_of_sight(const Grid& g, const float x1, const float z1, const float x2, const float z2) {
+        const float length = std::sqrt((x2 - x1) * (x2 - x1) + (z2 - z1) * (z2 - z1));
+        const int steps = (int) (length / 0.5f) + 1;
+        for (int i = 0; i <= steps; ++i) {
+            const float t = (float) i / steps;
+            const GridCoordinate cell = g.cell_of(x1 + (x2 - x1) * t, z1 + (z2 - z1) * t);
+            if (g.wall_at(cell.x, cell.z))
+                return false;
+        }
+        return true;
+    }
+
+    TEST(PotentiallyVisibleSet, objects_visible_from__never_hides_what_can_be_seen) {
+        std::stringstream level;
+        level <<
+            "x 12\n"
+            "z 9\n"
+            "cell_size 64\n"
+            "############\n"
+            "#...#.....##\n"
+            "#.#...#.#..#\n"
+            "#.##P.#....#\n"
+            "#..#..#.##.#\n"
+            "#.#....#...#\n"
+            "##..##.#.#.#\n"
+            "#.........##\n"
+            "############\n"
+            "player_start_orientation_rad 0\n"
+            "player_ammo 1\n";
+        const Grid& g = World::load(level).map;
+
+        // An enemy in every empty cell: the enemy visible from a cell is a cell visible from it.
+        std::vector<std::pair<float, float>> points;
+        std::vector<size_t> enemy_in_cell(g.x_size * g.z_size);
+        for (uint8_t z = 0; z < g.z_size; ++z)
+            for (uint8_t x = 0; x < g.x_size; ++x)
+                if (!g.wall_at(x, z)) {
+                    enemy_in_cell[z * g.x_size + x] = points.size();
+                    points.emplace_back(x * 64.0f, z * 64.0f);
+                }
+        const PotentiallyVisibleSet pvs(g, enemies_at(points));
+        const auto enemy_seen = [&g, &enemy_in_cell, &pvs](const GridCoordinate& from, const GridCoordinate& to) {
+            return (bool) pvs.objects_visible_from(from).enemies[enemy_in_cell[to.z * g.x_size + to.x]];
+        };
+
+        uint32_t hidden_pairs = 0;
+        for (float x1 = 3; x1 < 768; x1 += 23)
+            for (float z1 = 5; z1 < 576; z1 += 19) {
+                const GridCoordinate from = g.cell_of(x1, z1);
+                if (g.wall_at(from.x, from.z))
+                    continue;
+
+                for (float x2 = 7; x2 < 768; x2 += 31)
+                    for (float z2 = 11; z2 < 576; z2 += 29) {
+                        const GridCoordinate to = g.cell_of(x2, z2);
+                        if (g.wall_at(to.x, to.z))
+                            continue;
+
+                        if (clear_line_of_sight(g, x1, z1, x2, z2)) {
+                            ASSERT_TRUE(enemy_seen(from, to));
+                        }
+                        else if (!enemy_seen(from, to))
+                            ++hidden_pairs;
+                    }
+            }
+
+        ASSERT_LT(0, hidden_pairs);  // Not everything is visible, or the set would be useless.
+    }
+}
@@ -2,11 +2,15 @@
 
 #include "ProjectionPlane.h"
 
+#include <algorithm>
+#include <sstream>
 #include <vector>
 
 #include "Grid.h"
 #include "MockInterface.h"
+#include "PI.h"
 #include "Player.h"
+#include "Shading.h"
 #include "World.h"
 
 namespace rc {
@@ -15,18 +19,93 @@ namespace rc {
         ProjectionPlane p(320, 200, 60);
 
         ASSERT_EQ(320, p.columns);
+        ASSERT_EQ(200, p.rows);
         ASSERT_EQ(160, p.x_center);
         ASSERT_EQ(100, p.y_center);
         ASSERT_EQ(277, p.distance_to_POV);
         ASSERT_FLOAT_EQ(0.0032724924f, p.scan_step_radians);
     }
 
+    TEST(ProjectionPlane, Creation__stretched_to_display) {
+        ProjectionPlane p(160, 200, 60, 320);
+
+        ASSERT_EQ(160, p.columns);
+        ASSERT_EQ(80, p.x_center);
+        ASSERT_EQ(277, p.distance_to_POV);  // Same heights of the full resolution plane.
+        ASSERT_FLOAT_EQ(0.0032724924f * 2, p.scan_step_radians);
+    }
+
+    TEST(ProjectionPlane, Creation__8K_wide_FOV) {
+        ProjectionPlane p(7680, 4320, 170);
+
+        ASSERT_EQ(3840, p.x_center);
+        ASSERT_EQ(2160, p.y_center);
+        ASSERT_EQ(335, p.distance_to_POV);  // 3840 / tan(85 degrees) = 335.96.
+        ASSERT_NEAR(-85 * PI / 180, p.column_angles.front(), 1e-5);
+        ASSERT_FLOAT_EQ(0, p.column_angles.at(p.x_center));
+
+        // About 4 binary angle units between the columns: no 2 columns look the same way.
+        for (uint16_t column = 1; column < p.columns; ++column)
+            ASSERT_LT((int16_t) p.column_directions[column - 1].units, (int16_t) p.column_directions[column].units);
+    }
+
+    TEST(ProjectionPlane, Creation__distance_beyond_16_bits) {
+        ProjectionPlane p(7680, 4320, 5);
+
+        ASSERT_NEAR(87950, p.distance_to_POV, 2);  // 3840 / tan(2.5 degrees).
+    }
+
+    TEST(ProjectionPlane, Creation__FOV_out_of_range) {
+        ASSERT_ANY_THROW(ProjectionPlane(320, 200, 0));
+        ASSERT_ANY_THROW(ProjectionPlane(320, 200, 180));
+    }
+
     TEST(ProjectionPlane, project_slice__wall_slice) {
         ProjectionPlane p(320, 200, 60);
         const SliceProjection result = p.project_slice(277, 64);
 
         ASSERT_EQ(64, result.height);
         ASSERT_EQ(68, result.top_row);
+        ASSERT_FLOAT_EQ(0, result.texture_top);
+        ASSERT_FLOAT_EQ(1, result.texture_step);
+    }
+
+    TEST(ProjectionPlane, project_slice__narrow_FOV_wall_slice) {
+        ProjectionPlane p(7680, 4320, 5);
+        const SliceProjection result = p.project_slice(87950.0f / 2, 64);
+
+        ASSERT_NEAR(128, result.height, 1);  // The distance to the plane is not exactly 87950.
+        ASSERT_NEAR(2096, result.top_row, 1);
+    }
+
+    TEST(ProjectionPlane, project_slice__far_wall_step) {
+        ProjectionPlane p(320, 200, 60);
+        const SliceProjection result = p.project_slice(277 * 4, 64);
+
+        ASSERT_EQ(16, result.height);
+        ASSERT_EQ(92, result.top_row);
+        ASSERT_FLOAT_EQ(0, result.texture_top);
+        ASSERT_FLOAT_EQ(4, result.texture_step);
+    }
+
+    TEST(ProjectionPlane, project_slice__clipped_to_screen) {
+        ProjectionPlane p(320, 200, 60);
+        const SliceProjection result = p.project_slice(277.0f / 8, 64);  // 512 rows, 156 above and below the screen.
+
+        ASSERT_EQ(200, result.height);
+        ASSERT_EQ(0, result.top_row);
+        ASSERT_FLOAT_EQ(0.125f, result.texture_step);
+        ASSERT_FLOAT_EQ(19.5f, result.texture_top);
+    }
+
+    TEST(ProjectionPlane, project_slice__zero_distance_does_not_overflow) {
+        ProjectionPlane p(320, 200, 60);
+        const SliceProjection result = p.project_slice(0, 64);
+
+        ASSERT_EQ(200, result.height);
+        ASSERT_EQ(0, result.top_row);
+        ASSERT_LT(result.texture_top, 64);
+        ASSERT_LT(0, result.texture_top);
     }
 
 
@@ -54,9 +133,459 @@ namespace rc {
         plane.project_objects(w, mc);
 
         ASSERT_EQ(2, mc.column_calls.size());
-        ASSERT_EQ(61988, mc.top_row_calls.at(0));  // TODO: Severe underflow?
-        ASSERT_EQ(7296, mc.height_calls.at(0));
+        ASSERT_EQ(0, mc.top_row_calls.at(0));  // The slice is clipped: 7296 rows tall, only 200 in the screen.
+        ASSERT_EQ(200, mc.height_calls.at(0));
+    }
+
+    static Objects one_enemy(const float x, const float z) {
+        Objects o;
+        o.enemies.objects.emplace_back(x, z, 64, 0, TextureIndex::ENEMY);
+        o.enemies.build(1, 1);
+        return o;
+    }
+
+    TEST(ProjectionPlane, project_objects__sprite_in_front) {
+        ProjectionPlane plane(320, 200, 60);
+        Grid g(10, 10, 64);
+        Player p{ 32, 320, 0 };
+        World w{ g, p, one_enemy(32 + 277, 320) };
+        MockCanvas mc;
+
+        plane.project_objects(w, mc);
+
+        // atan(32 / 277) is about 35 columns on each side of the center.
+        ASSERT_EQ(71, mc.column_calls.size());
+        ASSERT_EQ(125, mc.column_calls.front());
+        ASSERT_EQ(195, mc.column_calls.back());
+        ASSERT_EQ(TextureIndex::ENEMY, mc.texture_calls.at(35));
+        ASSERT_EQ(64, mc.height_calls.at(35));
+        ASSERT_EQ(68, mc.top_row_calls.at(35));
+    }
+
+    TEST(ProjectionPlane, project_objects__sprite_behind_player) {
+        ProjectionPlane plane(320, 200, 60);
+        Grid g(10, 10, 64);
+        Player p{ 320, 320, 0 };
+        World w{ g, p, one_enemy(100, 320) };
+        MockCanvas mc;
+
+        plane.project_objects(w, mc);
+
+        ASSERT_TRUE(mc.column_calls.empty());
+    }
+
+    TEST(ProjectionPlane, project_objects__sprite_outside_field_of_view) {
+        ProjectionPlane plane(320, 200, 60);
+        Grid g(10, 10, 64);
+        Player p{ 32, 32, 0 };
+        World w{ g, p, one_enemy(132, 400) };  // About 75 degrees on the side.
+        MockCanvas mc;
+
+        plane.project_objects(w, mc);
+
+        ASSERT_TRUE(mc.column_calls.empty());
+    }
+
+    TEST(ProjectionPlane, project_objects__sprite_behind_wall) {
+        ProjectionPlane plane(320, 200, 60);
+        Grid g(10, 10, 64);
+        g.build_wall(2, 5);
+        Player p{ 32, 352, 0 };
+        World w{ g, p, one_enemy(352, 352) };
+        MockCanvas mc;
+
+        plane.project_objects(w, mc);
+
+        for (const TextureIndex drawn : mc.texture_calls)
+            ASSERT_EQ(TextureIndex::WALL, drawn);
+    }
+
+    TEST(ProjectionPlane, project_objects__sprite_in_front_of_wall) {
+        ProjectionPlane plane(320, 200, 60);
+        Grid g(10, 10, 64);
+        g.build_wall(8, 5);
+        Player p{ 32, 352, 0 };
+        World w{ g, p, one_enemy(352, 352) };
+        MockCanvas mc;
+
+        plane.project_objects(w, mc);
+
+        // Every column at the center has the wall and then, on top of it, the sprite.
+        const auto center = std::find(mc.column_calls.begin(), mc.column_calls.end(), 160) - mc.column_calls.begin();
+        ASSERT_EQ(TextureIndex::WALL, mc.texture_calls.at(center));
+        const auto sprite_center = std::find(mc.column_calls.begin() + center + 1, mc.column_calls.end(), 160) - mc.column_calls.begin();
+        ASSERT_EQ(TextureIndex::ENEMY, mc.texture_calls.at(sprite_center));
+    }
+
+    TEST(ProjectionPlane, project_slice__light_level_from_distance) {
+        ProjectionPlane p(320, 200, 60);
+
+        ASSERT_EQ(0, p.project_slice(10, 64).light_level);
+        ASSERT_EQ(light_level(1000), p.project_slice(1000, 64).light_level);
+        ASSERT_LT(0, p.project_slice(1000, 64).light_level);
+    }
+
+    TEST(ProjectionPlane, project_slice__fog) {
+        ProjectionPlane p(320, 200, 60);
+        p.view_distance = 500;
+        p.fog = true;
+
+        ASSERT_EQ(0, p.project_slice(10, 64).light_level);
+        ASSERT_EQ(LIGHT_LEVELS - 1, p.project_slice(500, 64).light_level);
+    }
+
+    TEST(ProjectionPlane, project_objects__wall_beyond_view_distance) {
+        ProjectionPlane plane(320, 200, 60);
+        Grid g(10, 10, 64);
+        g.build_wall(8, 5);
+        Player p{ 32, 352, 0 };
+        World w{ g, p, {} };
+        MockCanvas mc;
+
+        plane.view_distance = 400;
+        plane.project_objects(w, mc);
+        ASSERT_TRUE(mc.column_calls.empty());
+
+        plane.view_distance = 500;
+        plane.project_objects(w, mc);
+        ASSERT_FALSE(mc.column_calls.empty());
+    }
+
+    TEST(ProjectionPlane, project_objects__sprite_beyond_view_distance) {
+        ProjectionPlane plane(320, 200, 60);
+        Grid g(10, 10, 64);
+        Player p{ 32, 320, 0 };
+        World w{ g, p, one_enemy(32 + 277, 320) };
+        MockCanvas mc;
+
+        plane.view_distance = 200;
+        plane.project_objects(w, mc);
+
+        ASSERT_TRUE(mc.column_calls.empty());
+    }
+
+    TEST(ProjectionPlane, project_objects__sprite_not_in_visible_set) {
+        ProjectionPlane plane(320, 200, 60);
+        Grid g(10, 10, 64);
+        Player p{ 32, 320, 0 };
+        World w{ g, p, one_enemy(32 + 277, 320) };
+        w.visibility = PotentiallyVisibleSet(w.map, w.sprites);
+        MockCanvas seen;
+        plane.project_objects(w, seen);
+        ASSERT_FALSE(seen.column_calls.empty());
+
+        // A wall between the player and the enemy.
+        for (uint8_t z = 2; z < 9; ++z)
+            w.map.build_wall(3, z);
+        w.visibility = PotentiallyVisibleSet(w.map, w.sprites);
+        ASSERT_FALSE(w.visibility.objects_visible_from(w.map.cell_of(32, 320)).enemies[0]);
+
+        MockCanvas hidden;
+        plane.project_objects(w, hidden);
+        for (const TextureIndex drawn : hidden.texture_calls)
+            ASSERT_NE(TextureIndex::ENEMY, drawn);
+    }
+
+    TEST(ProjectionPlane, project_slice_rows__part_of_the_slice) {
+        ProjectionPlane plane(320, 200, 60);
+
+        // At this distance 1 texel is 1 row, the whole slice starts at row 68.
+        const SliceProjection s = plane.project_slice_rows(277, 64, 10, 20);
+
+        ASSERT_EQ(78, s.top_row);
+        ASSERT_EQ(10, s.height);
+        ASSERT_FLOAT_EQ(10, s.texture_top);
     }
 
-    // TODO: test projection of enemies.
-}
\ No newline at end of file
+    TEST(ProjectionPlane, project_slice_rows__clipped) {
+        ProjectionPlane plane(320, 200, 60);
+
+        const SliceProjection s = plane.project_slice_rows(277.0f / 4, 64, 0, 16);  // Rows -28 to 36.
+
+        ASSERT_EQ(0, s.top_row);
+        ASSERT_EQ(36, s.height);
+        ASSERT_FLOAT_EQ(7, s.texture_top);
+    }
+
+    TEST(ProjectionPlane, project_objects__sprite_only_visible_runs) {
+        ProjectionPlane plane(320, 200, 60);
+        Grid g(10, 10, 64);
+        Player p{ 32, 320, 0 };
+        World w{ g, p, one_enemy(32 + 277, 320) };
+
+        // Two opaque bands, only in the right half of the texture.
+        std::vector<uint32_t> pixels(64 * 64, 0);
+        for (uint16_t y = 10; y < 20; ++y)
+            std::fill(pixels.begin() + y * 64 + 32, pixels.begin() + y * 64 + 64, 0xFF000000);
+        for (uint16_t y = 40; y < 50; ++y)
+            std::fill(pixels.begin() + y * 64 + 32, pixels.begin() + y * 64 + 64, 0xFF000000);
+        w.masks.set(TextureIndex::ENEMY, AlphaMask(Texture(64, 64, pixels)));
+        MockCanvas mc;
+
+        plane.project_objects(w, mc);
+
+        ASSERT_EQ(0, mc.column_calls.size() % 2);
+        ASSERT_LE(mc.column_calls.size(), 2 * 36);
+        ASSERT_GE(mc.column_calls.size(), 2 * 34);
+        ASSERT_GE(mc.column_calls.front(), 159);
+        ASSERT_EQ(78, mc.top_row_calls.at(0));
+        ASSERT_EQ(10, mc.height_calls.at(0));
+        ASSERT_EQ(108, mc.top_row_calls.at(1));
+        ASSERT_EQ(10, mc.height_calls.at(1));
+    }
+
+    /** The far one has the exit texture, to give it a different mask. */
+    static Objects enemy_behind_enemy() {
+        Objects o;
+        o.enemies.objects.emplace_back(32.0f + 277, 320.0f, 64, 0, TextureIndex::ENEMY);
+        o.enemies.objects.emplace_back(32.0f + 2 * 277, 320.0f, 64, 1, TextureIndex::EXIT);
+        o.enemies.build(1, 1);
+        return o;
+    }
+
+    TEST(ProjectionPlane, project_objects__back_to_front_draws_hidden_sprites) {
+        ProjectionPlane plane(320, 200, 60);
+        Grid g(20, 20, 64);
+        Player p{ 32, 320, 0 };
+        World w{ g, p, enemy_behind_enemy() };
+        MockCanvas mc;
+
+        plane.project_objects(w, mc);
+
+        ASSERT_GT(mc.column_calls.size(), 71);
+        ASSERT_EQ(32, mc.height_calls.front());  // The far one first.
+    }
+
+    TEST(ProjectionPlane, project_objects__front_to_back_skips_hidden_sprites) {
+        ProjectionPlane plane(320, 200, 60);
+        plane.sprite_order = ProjectionPlane::SpriteOrder::FRONT_TO_BACK;
+        Grid g(20, 20, 64);
+        Player p{ 32, 320, 0 };
+        World w{ g, p, enemy_behind_enemy() };
+        MockCanvas mc;
+
+        plane.project_objects(w, mc);
+
+        // The far sprite is completely behind the closer one.
+        ASSERT_EQ(71, mc.column_calls.size());
+        ASSERT_EQ(64, mc.height_calls.front());
+    }
+
+    TEST(ProjectionPlane, project_objects__front_to_back_fills_the_holes) {
+        ProjectionPlane plane(320, 200, 60);
+        plane.sprite_order = ProjectionPlane::SpriteOrder::FRONT_TO_BACK;
+        Grid g(20, 20, 64);
+        Player p{ 32, 320, 0 };
+        World w{ g, p, enemy_behind_enemy() };
+
+        // The closer sprite is solid only in the top half.
+        std::vector<uint32_t> pixels(64 * 64, 0);
+        std::fill(pixels.begin(), pixels.begin() + 32 * 64, 0xFF000000);
+        w.masks.set(TextureIndex::ENEMY, AlphaMask(Texture(64, 64, pixels)));
+        MockCanvas mc;
+
+        plane.project_objects(w, mc);
+
+        // Half of the far one is visible below: rows 100 to 116, the bottom half of its texture.
+        const auto far_start = std::find(mc.texture_calls.begin(), mc.texture_calls.end(), TextureIndex::EXIT) - mc.texture_calls.begin();
+        const auto far_center = std::find(mc.column_calls.begin() + far_start, mc.column_calls.end(), 160) - mc.column_calls.begin();
+        ASSERT_EQ(TextureIndex::EXIT, mc.texture_calls.at(far_center));
+        ASSERT_EQ(100, mc.top_row_calls.at(far_center));
+        ASSERT_EQ(16, mc.height_calls.at(far_center));
+        ASSERT_FLOAT_EQ(32, mc.texture_top_calls.at(far_center));
+    }
+
+    TEST(ProjectionPlane, project_objects__wall_spans_same_face) {
+        ProjectionPlane plane(320, 200, 60);
+        plane.wall_drawing = ProjectionPlane::WallDrawing::SPANS;
+        Grid g(10, 10, 64);
+        for (uint8_t z = 0; z < 10; ++z)
+            g.build_wall(5, z);
+        Player p{ 288, 320, 0 };  // Looking at the long wall, 32 units away.
+        World w{ g, p, Objects() };
+        MockCanvas mc;
+
+        plane.project_objects(w, mc);
+
+        ASSERT_TRUE(mc.column_calls.empty());
+        ASSERT_FALSE(mc.span_calls.empty());
+        ASSERT_LT(mc.span_calls.size(), 320 / 10);
+
+        // All the columns, once each.
+        ASSERT_EQ(0, mc.span_calls.front().first_column);
+        ASSERT_EQ(319, mc.span_calls.back().last_column);
+        for (size_t i = 1; i < mc.span_calls.size(); ++i)
+            ASSERT_EQ(mc.span_calls.at(i - 1).last_column + 1, mc.span_calls.at(i).first_column);
+    }
+
+    TEST(ProjectionPlane, project_objects__wall_spans_like_slices) {
+        ProjectionPlane slices(320, 200, 60);
+        ProjectionPlane spans(320, 200, 60);
+        spans.wall_drawing = ProjectionPlane::WallDrawing::SPANS;
+        Grid g(10, 10, 64);
+        g.build_wall(7, 4);
+        g.build_wall(7, 5);
+        g.build_wall(6, 6);
+        g.build_wall(8, 3);
+        Player p{ 100, 300, 0.2f };
+        World w{ g, p, Objects() };
+        MockCanvas by_slice;
+        MockCanvas by_span;
+
+        slices.project_objects(w, by_slice);
+        spans.project_objects(w, by_span);
+
+        // Within the rounding of the interpolation (half a pixel may round the other way).
+        size_t slice_index = 0;
+        for (const WallSpan& span : by_span.span_calls)
+            for (uint16_t column = span.first_column; column <= span.last_column; ++column) {
+                while (by_slice.column_calls.at(slice_index) != column)
+                    ++slice_index;
+                const SliceProjection s = span.slice_at(column, 200);
+                ASSERT_NEAR(by_slice.top_row_calls.at(slice_index), s.top_row, 1);
+                ASSERT_NEAR(by_slice.height_calls.at(slice_index), s.height, 2);
+            }
+        ASSERT_GT(by_slice.column_calls.size(), 5 * by_span.span_calls.size());
+    }
+
+    static World pillars_level() {
+        std::stringstream level;
+        level <<
+            "x 10\n"
+            "z 8\n"
+            "cell_size 64\n"
+            "##########\n"
+            "#...#....#\n"
+            "#.#...#..#\n"
+            "#....P...#\n"
+            "#..#..#.##\n"
+            "#.#......#\n"
+            "#...##...#\n"
+            "##########\n"
+            "player_start_orientation_rad 0\n"
+            "player_ammo 1\n";
+        return World::load(level);
+    }
+
+    TEST(ProjectionPlane, project_objects__adaptive_sampling_same_walls) {
+        ProjectionPlane every_column(320, 200, 60);
+        ProjectionPlane adaptive(320, 200, 60);
+        adaptive.wall_sampling = ProjectionPlane::WallSampling::ADAPTIVE;
+        World w = pillars_level();
+
+        uint32_t all_searches = 0;
+        uint32_t adaptive_searches = 0;
+        for (float x = 80; x < 576; x += 37)
+            for (float z = 80; z < 448; z += 29)
+                for (float orientation = 0; orientation < 6.28f; orientation += 0.35f) {
+                    const GridCoordinate cell = w.map.cell_of(x, z);
+                    if (w.map.wall_at(cell.x, cell.z))
+                        continue;
+
+                    w.player = Player{ x, z, orientation };
+                    MockCanvas expected;
+                    MockCanvas result;
+
+                    every_column.project_objects(w, expected);
+                    adaptive.project_objects(w, result);
+
+                    ASSERT_EQ(expected.column_calls, result.column_calls);
+                    ASSERT_EQ(expected.top_row_calls, result.top_row_calls);
+                    ASSERT_EQ(expected.height_calls, result.height_calls);
+                    ASSERT_EQ(expected.texture_top_calls, result.texture_top_calls);
+                    ASSERT_EQ(expected.texture_offset_calls, result.texture_offset_calls);
+                    ASSERT_EQ(expected.texture_calls, result.texture_calls);
+
+                    all_searches += every_column.wall_searches;
+                    adaptive_searches += adaptive.wall_searches;
+                }
+
+        ASSERT_LT(adaptive_searches * 4, all_searches);
+    }
+
+    /** Not a Canvas at all: only the two calls that the projection needs. */
+    struct CallCounter {
+        void draw_slice(const uint16_t column, const SliceProjection& slice, const uint16_t texture_offset, const TextureIndex what_to_draw) {
+            ++slices;
+            columns_sum += column;
+        }
+
+        void draw_span(const WallSpan& span, const TextureIndex what_to_draw) {
+            ++spans;
+        }
+
+        uint32_t slices = 0;
+        uint32_t spans = 0;
+        uint32_t columns_sum = 0;
+    };
+
+    TEST(ProjectionPlane, project_objects__any_canvas_type) {
+        ProjectionPlane plane(320, 200, 60);
+        World w = pillars_level();
+        w.player = Player{ 300, 220, 0.3f };
+        MockCanvas expected;
+        CallCounter result;
+
+        plane.project_objects(w, expected);
+        plane.project_objects(w, result);
+
+        ASSERT_EQ(expected.column_calls.size(), result.slices);
+        ASSERT_EQ(0, result.spans);
+        uint32_t columns_sum = 0;
+        for (const uint16_t column : expected.column_calls)
+            columns_sum += column;
+        ASSERT_EQ(columns_sum, result.columns_sum);
+    }
+
+    TEST(ProjectionPlane, project_objects__through_canvas_interface) {
+        ProjectionPlane plane(320, 200, 60);
+        plane.wall_drawing = ProjectionPlane::WallDrawing::SPANS;
+        World w = pillars_level();
+        w.player = Player{ 300, 220, 2.1f };
+        MockCanvas direct;
+        MockCanvas adapted;
+        Canvas& any_canvas = adapted;
+
+        plane.project_objects(w, direct);
+        plane.project_objects(w, any_canvas);
+
+        ASSERT_EQ(direct.column_calls, adapted.column_calls);
+        ASSERT_EQ(direct.height_calls, adapted.height_calls);
+        ASSERT_EQ(direct.span_calls.size(), adapted.span_calls.size());
+        ASSERT_LT(0, adapted.span_calls.size());
+    }
+
+    TEST(ProjectionPlane, project_objects__from_a_camera) {
+        ProjectionPlane plane(320, 200, 60);
+        World w = pillars_level();
+        w.player = Player{ 300, 220, 1.2f };
+        MockCanvas from_player;
+        MockCanvas from_camera;
+
+        plane.project_objects(w, from_player);
+        const Camera camera = w.player.camera();
+        w.player = Player{ 100, 100, 4 };  // Does not matter any more.
+        plane.project_objects(w, camera, from_camera);
+
+        ASSERT_EQ(from_player.column_calls, from_camera.column_calls);
+        ASSERT_EQ(from_player.height_calls, from_camera.height_calls);
+        ASSERT_EQ(from_player.texture_offset_calls, from_camera.texture_offset_calls);
+    }
+
+    TEST(ProjectionPlane, project_objects__8K_wide_FOV) {
+        ProjectionPlane plane(7680, 4320, 170);
+        World w = pillars_level();
+        w.player = Player{ 300, 220, 1.2f };
+        MockCanvas result;
+
+        plane.project_objects(w, result);
+
+        // Closed level: there is a wall in every column, all on the screen.
+        std::vector<bool> column_drawn(plane.columns, false);
+        for (size_t call = 0; call < result.column_calls.size(); ++call) {
+            column_drawn.at(result.column_calls[call]) = true;
+            ASSERT_LE(result.top_row_calls[call] + result.height_calls[call], plane.rows);
+        }
+        ASSERT_EQ(plane.columns, std::count(column_drawn.begin(), column_drawn.end(), true));
+    }
+}
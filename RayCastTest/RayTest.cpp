@@ -1,5 +1,6 @@
 #include "pch.h"
 
+#include "PI.h"
 #include "Ray.h"
 
 namespace rc {
@@ -9,7 +10,18 @@ namespace rc {
 
         ASSERT_EQ(1, r.x);
         ASSERT_EQ(2, r.z);
-        ASSERT_EQ(3, r.alpha_rad);
+        ASSERT_NEAR(3, r.alpha.radians(), BinaryAngle::RESOLUTION_RADIANS);
+    }
+
+    TEST(Ray, facing) {
+        ASSERT_TRUE(Ray(0, 0, 0).facing_up());
+        ASSERT_TRUE(Ray(0, 0, 0).facing_right());
+        ASSERT_FALSE(Ray(0, 0, PI).facing_up());
+        ASSERT_FALSE(Ray(0, 0, PI).facing_right());
+        ASSERT_FALSE(Ray(0, 0, PI / 2).facing_right());
+        ASSERT_TRUE(Ray(0, 0, 3 * PI / 2).facing_right());
+        ASSERT_FALSE(Ray(0, 0, -0.1f).facing_up());
+        ASSERT_TRUE(Ray(0, 0, -0.1f).facing_right());
     }
 
     TEST(RayHit, construction) {
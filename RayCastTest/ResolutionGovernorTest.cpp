@@ -0,0 +1,66 @@
+#include "pch.h"
+
+#include "ResolutionGovernor.h"
+
+#include <vector>
+
+namespace rc {
+
+    static void render_frames(ResolutionGovernor& g, const float ms_per_column, const uint16_t frames) {
+        for (uint16_t i = 0; i < frames; ++i)
+            g.frame_rendered(ms_per_column * g.columns());
+    }
+
+    TEST(ResolutionGovernor, creation__no_levels) {
+        ASSERT_ANY_THROW(ResolutionGovernor({}, 16));
+    }
+
+    TEST(ResolutionGovernor, creation__starts_with_most_columns) {
+        const ResolutionGovernor g({ 160, 640, 320 }, 16);
+
+        ASSERT_EQ(0, g.level());
+        ASSERT_EQ(640, g.columns());
+        ASSERT_EQ(160, g.column_levels.back());
+    }
+
+    TEST(ResolutionGovernor, frame_rendered__single_slow_frame) {
+        ResolutionGovernor g({ 640, 320 }, 16);
+
+        g.frame_rendered(100);
+
+        ASSERT_EQ(640, g.columns());
+    }
+
+    TEST(ResolutionGovernor, frame_rendered__too_slow_goes_down) {
+        ResolutionGovernor g({ 640, 480, 320, 240, 160 }, 16);
+
+        render_frames(g, 0.05f, 30);  // 32 ms at 640 columns. 240 columns take 12 ms.
+
+        ASSERT_EQ(240, g.columns());
+    }
+
+    TEST(ResolutionGovernor, frame_rendered__faster_goes_up) {
+        ResolutionGovernor g({ 640, 480, 320, 240, 160 }, 16);
+        render_frames(g, 0.05f, 30);
+
+        render_frames(g, 0.01f, 30);
+
+        ASSERT_EQ(640, g.columns());
+    }
+
+    TEST(ResolutionGovernor, frame_rendered__close_to_budget_stays) {
+        ResolutionGovernor g({ 640, 320 }, 16);
+
+        render_frames(g, 15.0f / 640, 100);  // Not enough margin to be sure, but within the budget.
+
+        ASSERT_EQ(640, g.columns());
+    }
+
+    TEST(ResolutionGovernor, frame_rendered__nothing_fits) {
+        ResolutionGovernor g({ 640, 320 }, 16);
+
+        render_frames(g, 1, 30);
+
+        ASSERT_EQ(320, g.columns());
+    }
+}
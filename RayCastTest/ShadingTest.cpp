@@ -0,0 +1,67 @@
+#include "pch.h"
+
+#include "Shading.h"
+
+#include <vector>
+
+#include "Texture.h"
+
+namespace rc {
+
+    TEST(Shading, light_level__close_is_full_light) {
+        ASSERT_EQ(0, light_level(0));
+        ASSERT_EQ(0, light_level(LIGHT_LEVEL_DISTANCE - 1));
+    }
+
+    TEST(Shading, light_level__one_level_each_step) {
+        ASSERT_EQ(1, light_level(LIGHT_LEVEL_DISTANCE));
+        ASSERT_EQ(3, light_level(LIGHT_LEVEL_DISTANCE * 3.5f));
+    }
+
+    TEST(Shading, light_level__far_is_darkest) {
+        ASSERT_EQ(LIGHT_LEVELS - 1, light_level(1e30f));
+    }
+
+    TEST(Shading, fog_light_level__darkest_at_view_distance) {
+        ASSERT_EQ(LIGHT_LEVELS - 1, fog_light_level(100, 100));
+        ASSERT_EQ(LIGHT_LEVELS - 1, fog_light_level(1000, 100));
+    }
+
+    TEST(Shading, fog_light_level__fades_with_distance) {
+        ASSERT_EQ(0, fog_light_level(0, 100));
+        ASSERT_EQ((LIGHT_LEVELS - 1) / 2, fog_light_level(50, 100));
+    }
+
+    TEST(Shading, fog_light_level__never_brighter_than_without_fog) {
+        ASSERT_EQ(light_level(LIGHT_LEVEL_DISTANCE * 5), fog_light_level(LIGHT_LEVEL_DISTANCE * 5, 1e30f));
+    }
+
+    TEST(Colormap, full_light__same_color) {
+        const Colormap c(0);
+
+        ASSERT_EQ(0xFF123456, c.shade(0xFF123456));
+    }
+
+    TEST(Colormap, darkest__keeps_alpha) {
+        const Colormap c(LIGHT_LEVELS - 1);
+
+        ASSERT_EQ(0x80333333, c.shade(0x80FFFFFF));  // 255 * 0.2 = 51.
+    }
+
+    TEST(ShadedTexture, variants__all_levels_all_mipmaps) {
+        const ShadedTexture t(Texture(4, 4, std::vector<uint32_t>(16, 0xFFFFFFFF)), LIGHT_LEVELS);
+
+        ASSERT_EQ(3, t.mip_levels);
+        ASSERT_EQ(LIGHT_LEVELS * 3, t.variants.size());
+        ASSERT_EQ(2, t.variant(5, 1).width);
+        ASSERT_EQ(0xFFFFFFFF, t.variant(0, 2).pixel(0, 0));
+        ASSERT_EQ(0xFF333333, t.variant(LIGHT_LEVELS - 1, 2).pixel(0, 0));
+    }
+
+    TEST(ShadedTexture, variant__single_level_never_shaded) {
+        const ShadedTexture t(Texture(1, 1, { 0xFFFFFFFF }), 1);
+
+        ASSERT_EQ(0xFFFFFFFF, t.variant(LIGHT_LEVELS - 1, 0).pixel(0, 0));
+        ASSERT_EQ(0xFFFFFFFF, t.variant(0, 3).pixel(0, 0));
+    }
+}
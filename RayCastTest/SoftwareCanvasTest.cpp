@@ -0,0 +1,124 @@
+#include "pch.h"
+
+#include "SoftwareCanvas.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "Shading.h"
+#include "Texture.h"
+
+namespace rc {
+
+    constexpr uint32_t BACKGROUND = 0xFF000000;
+    constexpr uint32_t WHITE = 0xFFFFFFFF;
+    constexpr uint32_t INVISIBLE = 0x00FFFFFF;
+
+    /** 2 * 2 texture: white on top, transparent below. */
+    static SoftwareCanvas canvas_with_texture() {
+        SoftwareCanvas c(4, 8);
+        c.clear(BACKGROUND);
+        c.set_texture(TextureIndex::WALL, ShadedTexture(Texture(2, 2, { WHITE, WHITE, INVISIBLE, INVISIBLE }), LIGHT_LEVELS));
+        return c;
+    }
+
+    static SliceProjection slice(const uint16_t top_row, const uint16_t height, const uint8_t light_level) {
+        SliceProjection s;
+        s.top_row = top_row;
+        s.height = height;
+        s.texture_top = 0;
+        s.texture_step = 2.0f / height;
+        s.light_level = light_level;
+        return s;
+    }
+
+    TEST(SoftwareCanvas, clear) {
+        SoftwareCanvas c(2, 2);
+
+        c.clear(WHITE);
+
+        ASSERT_EQ(WHITE, c.pixel(1, 1));
+    }
+
+    TEST(SoftwareCanvas, draw_slice__scales_the_column) {
+        SoftwareCanvas c = canvas_with_texture();
+
+        c.draw_slice(1, slice(2, 4, 0), 0, TextureIndex::WALL);
+
+        ASSERT_EQ(BACKGROUND, c.pixel(1, 1));
+        ASSERT_EQ(WHITE, c.pixel(1, 2));
+        ASSERT_EQ(WHITE, c.pixel(1, 3));
+        ASSERT_EQ(BACKGROUND, c.pixel(0, 2));
+    }
+
+    TEST(SoftwareCanvas, draw_slice__skips_transparent_texels) {
+        SoftwareCanvas c = canvas_with_texture();
+
+        c.draw_slice(1, slice(2, 4, 0), 0, TextureIndex::WALL);
+
+        ASSERT_EQ(BACKGROUND, c.pixel(1, 4));
+        ASSERT_EQ(BACKGROUND, c.pixel(1, 5));
+    }
+
+    TEST(SoftwareCanvas, draw_slice__shaded) {
+        SoftwareCanvas c = canvas_with_texture();
+
+        c.draw_slice(1, slice(2, 4, LIGHT_LEVELS - 1), 0, TextureIndex::WALL);
+
+        ASSERT_EQ(Colormap(LIGHT_LEVELS - 1).shade(WHITE), c.pixel(1, 2));
+    }
+
+    TEST(SoftwareCanvas, draw_span__same_as_slices) {
+        SoftwareCanvas by_span = canvas_with_texture();
+        SoftwareCanvas by_slice = canvas_with_texture();
+        WallSpan span;
+        span.first_column = 0;
+        span.last_column = 3;
+        span.first_height = 8;
+        span.last_height = 4;
+        span.first_offset = 0;
+        span.last_offset = 1.5f;
+        span.object_size = 2;
+        span.light_level = 0;
+
+        by_span.draw_span(span, TextureIndex::WALL);
+        for (uint16_t column = 0; column < 4; ++column)
+            by_slice.draw_slice(column, span.slice_at(column, 8), (uint16_t) span.offset_at(column), TextureIndex::WALL);
+
+        ASSERT_EQ(by_slice.pixels, by_span.pixels);
+        ASSERT_EQ(WHITE, by_span.pixel(0, 0));
+    }
+
+    TEST(SoftwareCanvas, draw_span__clipped_same_as_slices) {
+        SoftwareCanvas by_span = canvas_with_texture();
+        SoftwareCanvas by_slice = canvas_with_texture();
+        WallSpan span;
+        span.first_column = 1;
+        span.last_column = 6;  // Beyond the right border.
+        span.first_height = 3;
+        span.last_height = 20;  // Taller than the frame.
+        span.first_offset = 0.5f;
+        span.last_offset = 2;
+        span.object_size = 2;
+        span.light_level = 0;
+
+        by_span.draw_span(span, TextureIndex::WALL);
+        for (uint16_t column = 1; column < 4; ++column)
+            by_slice.draw_slice(column, span.slice_at(column, 8),
+                (uint16_t) std::min(span.offset_at(column), 1.0f), TextureIndex::WALL);
+
+        ASSERT_EQ(by_slice.pixels, by_span.pixels);
+        ASSERT_EQ(WHITE, by_span.pixel(3, 0));
+    }
+
+    TEST(SoftwareCanvas, draw_image__clipped_to_the_frame) {
+        SoftwareCanvas c(4, 8);
+        c.clear(BACKGROUND);
+        c.set_texture(TextureIndex::HUD, ShadedTexture(Texture(2, 2, { WHITE, WHITE, WHITE, WHITE }), 1));
+
+        c.draw_image(3, 7, TextureIndex::HUD);
+
+        ASSERT_EQ(WHITE, c.pixel(3, 7));
+        ASSERT_EQ(BACKGROUND, c.pixel(2, 7));
+    }
+}
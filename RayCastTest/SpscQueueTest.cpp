@@ -0,0 +1,84 @@
+#include "pch.h"
+
+#include "SpscQueue.h"
+
+#include <thread>
+
+namespace rc {
+
+    TEST(SpscQueue, pop__empty) {
+        SpscQueue<int, 4> q;
+        int item = 7;
+
+        ASSERT_FALSE(q.pop(item));
+        ASSERT_EQ(7, item);
+    }
+
+    TEST(SpscQueue, pop__same_order_of_push) {
+        SpscQueue<int, 4> q;
+        q.push(1);
+        q.push(2);
+        int item = 0;
+
+        ASSERT_TRUE(q.pop(item));
+        ASSERT_EQ(1, item);
+        ASSERT_TRUE(q.pop(item));
+        ASSERT_EQ(2, item);
+        ASSERT_FALSE(q.pop(item));
+    }
+
+    TEST(SpscQueue, push__full) {
+        SpscQueue<int, 4> q;
+        for (int i = 0; i < 4; ++i)
+            ASSERT_TRUE(q.push(i));
+
+        ASSERT_FALSE(q.push(4));
+
+        int item = 0;
+        q.pop(item);
+        ASSERT_EQ(0, item);
+        ASSERT_TRUE(q.push(4));  // There is room again.
+    }
+
+    TEST(SpscQueue, push__wraps_around_the_ring) {
+        SpscQueue<int, 4> q;
+        int item = 0;
+
+        for (int i = 0; i < 10; ++i) {
+            ASSERT_TRUE(q.push(i));
+            ASSERT_TRUE(q.push(i + 100));
+            ASSERT_TRUE(q.pop(item));
+            ASSERT_EQ(i, item);
+            ASSERT_TRUE(q.pop(item));
+            ASSERT_EQ(i + 100, item);
+        }
+    }
+
+    TEST(SpscQueue, two_threads__nothing_lost_nothing_reordered) {
+        SpscQueue<int, 8> q;
+        constexpr int items = 100000;
+
+        std::thread producer([&q]() {
+            for (int i = 0; i < items; ++i)
+                while (!q.push(i))
+                    std::this_thread::yield();
+        });
+
+        // No assert until the producer is joined, a thread that is still joinable would abort the test program.
+        int popped = 0;
+        int out_of_order = 0;
+        int item = -1;
+        while (popped < items) {
+            if (q.pop(item)) {
+                out_of_order += item != popped;
+                ++popped;
+            }
+            else
+                std::this_thread::yield();
+        }
+
+        producer.join();
+        ASSERT_EQ(0, out_of_order);
+        ASSERT_FALSE(q.pop(item));
+    }
+}
@@ -0,0 +1,37 @@
+#include "pch.h"
+
+#include "StreamRefiller.h"
+
+#include <thread>
+#include <vector>
+
+#include "TestWav.h"
+
+namespace rc {
+
+    TEST(StreamRefiller, refills_what_is_taken) {
+        MusicStream first(wav_stream(std::vector<int16_t>(100, 1), 1), 32);
+        MusicStream second(wav_stream(std::vector<int16_t>(100, 2), 2), 32);
+        std::vector<int16_t> output(2 * 20);
+        first.take(output.data(), 20);
+        second.take(output.data(), 20);
+
+        const StreamRefiller refiller({ &first, &second }, std::chrono::milliseconds(1));
+        for (int attempt = 0; attempt < 1000 && (first.buffered_frames() < 32 || second.buffered_frames() < 32); ++attempt)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        ASSERT_EQ(32, first.buffered_frames());
+        ASSERT_EQ(32, second.buffered_frames());
+    }
+
+    TEST(StreamRefiller, stops_without_waiting_the_period) {
+        MusicStream stream(wav_stream({ 1, 2, 3 }, 1), 2);
+        const auto start = std::chrono::steady_clock::now();
+
+        {
+            const StreamRefiller refiller({ &stream }, std::chrono::hours(1));
+        }
+
+        ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(10));
+    }
+}
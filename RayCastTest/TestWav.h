@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace rc {
+
+    inline void append_little_endian(std::string& bytes, const uint32_t value, const uint8_t count) {
+        for (uint8_t i = 0; i < count; ++i)
+            bytes.push_back((char) ((value >> (8 * i)) & 0xFF));
+    }
+
+    /** The bytes of a wav file with these samples (interleaved if stereo), a format chunk and a chunk to skip. */
+    inline std::string wav_bytes(const std::vector<int16_t>& samples, const uint16_t channels, const uint16_t bits = 16) {
+        std::string bytes = "RIFF";
+        append_little_endian(bytes, 0, 4);  // The reader does not need it.
+        bytes += "WAVE";
+
+        bytes += "LIST";
+        append_little_endian(bytes, 3, 4);
+        bytes += "abc";
+        bytes.push_back(0);  // Padding to the even offset.
+
+        bytes += "fmt ";
+        append_little_endian(bytes, 16, 4);
+        append_little_endian(bytes, 1, 2);
+        append_little_endian(bytes, channels, 2);
+        append_little_endian(bytes, 44100, 4);
+        append_little_endian(bytes, 44100 * channels * bits / 8, 4);
+        append_little_endian(bytes, channels * bits / 8, 2);
+        append_little_endian(bytes, bits, 2);
+
+        bytes += "data";
+        append_little_endian(bytes, (uint32_t) samples.size() * 2, 4);
+        for (const int16_t sample : samples)
+            append_little_endian(bytes, (uint16_t) sample, 2);
+        return bytes;
+    }
+
+    inline std::unique_ptr<std::istream> wav_stream(const std::vector<int16_t>& samples, const uint16_t channels) {
+        return std::make_unique<std::stringstream>(wav_bytes(samples, channels));
+    }
+}
@@ -0,0 +1,78 @@
+#include "pch.h"
+
+#include "Texture.h"
+
+#include <vector>
+
+namespace rc {
+
+    static Texture uniform_texture(const uint16_t side, const uint32_t color) {
+        return Texture(side, side, std::vector<uint32_t>(side * side, color));
+    }
+
+    TEST(Texture, creation__wrong_size) {
+        ASSERT_ANY_THROW(Texture(2, 2, { 0, 0, 0 }));
+    }
+
+    TEST(Texture, pixel__row_by_row) {
+        const Texture t(2, 2, { 1, 2, 3, 4 });
+
+        ASSERT_EQ(2, t.pixel(1, 0));
+        ASSERT_EQ(3, t.pixel(0, 1));
+    }
+
+    TEST(Texture, half_size__averages_block) {
+        const Texture t(2, 2, { 0xFF000000, 0xFF0000FF, 0xFF00FF00, 0xFFFF0000 });
+
+        const Texture half = t.half_size();
+
+        ASSERT_EQ(1, half.width);
+        ASSERT_EQ(1, half.height);
+        ASSERT_EQ(0xFF3F3F3F, half.pixel(0, 0));
+    }
+
+    TEST(Texture, half_size__transparent_pixels_do_not_bleed) {
+        // Two white, opaque pixels and two black, invisible ones. Must stay white, but half transparent.
+        const Texture t(2, 2, { 0xFFFFFFFF, 0x00000000, 0x00000000, 0xFFFFFFFF });
+
+        const Texture half = t.half_size();
+
+        ASSERT_EQ(0x7FFFFFFF, half.pixel(0, 0));
+    }
+
+    TEST(Texture, half_size__odd_size) {
+        const Texture t = uniform_texture(3, 0xFF102030);
+
+        const Texture half = t.half_size();
+
+        ASSERT_EQ(1, half.width);
+        ASSERT_EQ(0xFF102030, half.pixel(0, 0));
+    }
+
+    TEST(Texture, mip_chain__down_to_one_pixel) {
+        const std::vector<Texture> chain = mip_chain(uniform_texture(64, 0xFFFFFFFF));
+
+        ASSERT_EQ(7, chain.size());
+        ASSERT_EQ(64, chain.at(0).width);
+        ASSERT_EQ(32, chain.at(1).width);
+        ASSERT_EQ(1, chain.at(6).width);
+        ASSERT_EQ(1, chain.at(6).height);
+    }
+
+    TEST(Texture, mip_level__close_uses_original) {
+        ASSERT_EQ(0, mip_level(64, 64, 7));
+        ASSERT_EQ(0, mip_level(64, 500, 7));
+        ASSERT_EQ(0, mip_level(64, 33, 7));
+    }
+
+    TEST(Texture, mip_level__far_uses_smaller) {
+        ASSERT_EQ(1, mip_level(64, 32, 7));
+        ASSERT_EQ(4, mip_level(64, 3, 7));
+        ASSERT_EQ(6, mip_level(64, 1, 7));
+        ASSERT_EQ(6, mip_level(64, 0, 7));
+    }
+
+    TEST(Texture, mip_level__limited_by_chain) {
+        ASSERT_EQ(2, mip_level(64, 1, 3));
+    }
+}
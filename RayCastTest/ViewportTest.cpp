@@ -0,0 +1,42 @@
+#include "pch.h"
+
+#include "Viewport.h"
+
+#include "MockInterface.h"
+
+namespace rc {
+
+    TEST(Viewport, draw_slice__moved_to_the_corner) {
+        MockCanvas mc;
+        Viewport<MockCanvas> viewport(mc, 320, 240, 200);
+        const SliceProjection slice{ 10, 50, 0, 1, 0 };
+
+        viewport.draw_slice(5, slice, 7, TextureIndex::WALL);
+
+        ASSERT_EQ(325, mc.column_calls.at(0));
+        ASSERT_EQ(250, mc.top_row_calls.at(0));
+        ASSERT_EQ(50, mc.height_calls.at(0));
+        ASSERT_EQ(7, mc.texture_offset_calls.at(0));
+    }
+
+    TEST(Viewport, draw_span__as_slices_on_the_viewport_horizon) {
+        MockCanvas mc;
+        Viewport<MockCanvas> viewport(mc, 100, 300, 200);
+        WallSpan span;
+        span.first_column = 10;
+        span.last_column = 12;
+        span.first_height = 40;
+        span.last_height = 40;
+        span.first_offset = 0;
+        span.last_offset = 2;
+        span.object_size = 64;
+        span.light_level = 0;
+
+        viewport.draw_span(span, TextureIndex::WALL);
+
+        ASSERT_TRUE(mc.span_calls.empty());
+        ASSERT_EQ((std::vector<uint16_t>{ 110, 111, 112 }), mc.column_calls);
+        ASSERT_EQ(300 + 100 - 20, mc.top_row_calls.at(0));  // Centered on the viewport, not on the canvas.
+        ASSERT_EQ((std::vector<uint16_t>{ 0, 1, 2 }), mc.texture_offset_calls);
+    }
+}
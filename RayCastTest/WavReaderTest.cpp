@@ -0,0 +1,94 @@
+#include "pch.h"
+
+#include "WavReader.h"
+
+#include <sstream>
+#include <vector>
+
+#include "TestWav.h"
+
+namespace rc {
+
+    TEST(WavReader, creation__header) {
+        std::stringstream file(wav_bytes({ 1, 2, 3, 4, 5, 6 }, 2));
+
+        const WavReader reader(file);
+
+        ASSERT_EQ(2, reader.channels);
+        ASSERT_EQ(44100, reader.frequency);
+        ASSERT_EQ(3, reader.frames);
+    }
+
+    TEST(WavReader, creation__not_a_wav) {
+        std::stringstream file("RIFF1234AVI LIST");
+
+        ASSERT_ANY_THROW(WavReader reader(file));
+    }
+
+    TEST(WavReader, creation__truncated_header) {
+        std::stringstream file(wav_bytes({ 1, 2 }, 2).substr(0, 30));
+
+        ASSERT_ANY_THROW(WavReader reader(file));
+    }
+
+    TEST(WavReader, creation__8_bits) {
+        std::stringstream file(wav_bytes({ 1, 2 }, 2, 8));
+
+        ASSERT_ANY_THROW(WavReader reader(file));
+    }
+
+    TEST(WavReader, read__stereo) {
+        std::stringstream file(wav_bytes({ 1, -2, 300, -4000, 32767, -32768 }, 2));
+        WavReader reader(file);
+        std::vector<int16_t> samples(6);
+
+        ASSERT_EQ(3, reader.read(samples.data(), 3));
+
+        ASSERT_EQ(std::vector<int16_t>({ 1, -2, 300, -4000, 32767, -32768 }), samples);
+    }
+
+    TEST(WavReader, read__mono_on_both_channels) {
+        std::stringstream file(wav_bytes({ 1, -2, 300 }, 1));
+        WavReader reader(file);
+        std::vector<int16_t> samples(6);
+
+        ASSERT_EQ(3, reader.read(samples.data(), 3));
+
+        ASSERT_EQ(std::vector<int16_t>({ 1, 1, -2, -2, 300, 300 }), samples);
+    }
+
+    TEST(WavReader, read__in_pieces_up_to_the_end) {
+        std::stringstream file(wav_bytes({ 1, 2, 3 }, 1));
+        WavReader reader(file);
+        std::vector<int16_t> samples(4, 9);
+
+        ASSERT_EQ(2, reader.read(samples.data(), 2));
+        ASSERT_EQ(1, reader.read(samples.data(), 2));
+        ASSERT_EQ(0, reader.read(samples.data(), 2));
+
+        ASSERT_EQ(std::vector<int16_t>({ 3, 3, 2, 2 }), samples);
+    }
+
+    TEST(WavReader, read__truncated_data) {
+        const std::string bytes = wav_bytes({ 1, 2, 3, 4 }, 1);
+        std::stringstream file(bytes.substr(0, bytes.size() - 3));  // The last sample, and half of the one before.
+        WavReader reader(file);
+        std::vector<int16_t> samples(8);
+
+        ASSERT_EQ(2, reader.read(samples.data(), 4));
+        ASSERT_EQ(2, reader.frames);
+    }
+
+    TEST(WavReader, rewind) {
+        std::stringstream file(wav_bytes({ 1, 2 }, 1));
+        WavReader reader(file);
+        std::vector<int16_t> samples(4);
+        reader.read(samples.data(), 2);
+        reader.read(samples.data(), 2);
+
+        reader.rewind();
+
+        ASSERT_EQ(1, reader.read(samples.data(), 1));
+        ASSERT_EQ(1, samples[0]);
+    }
+}
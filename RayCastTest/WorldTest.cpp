@@ -2,6 +2,8 @@
 
 #include "World.h"
 
+#include "PI.h"
+
 #include <sstream>
 
 // TODO: not sure I can get the same effect of "piece of a multi-literal string" with a constexpr.
@@ -153,7 +155,7 @@ namespace rc {
 
         ASSERT_EQ(32, p.x_position);
         ASSERT_EQ(96, p.z_position);
-        ASSERT_EQ(12.5, p.orientation);
+        ASSERT_NEAR(12.5 - 2 * PI, p.orientation.radians(), BinaryAngle::RESOLUTION_RADIANS);  // Wrapped around.
         ASSERT_EQ(30, p.bullets_left);
     }
 
@@ -173,6 +175,42 @@ namespace rc {
         // Sprite x and z are private. I would have to test via the intersection, but that is complicated...
     }
     
+    TEST(World, load__first_version) {
+        std::stringstream world_text;
+        world_text <<
+            "x 2\n"
+            "z 1\n"
+            CELL_SIZE_NOT_IMPORTANT
+            "EP\n"
+            PLAYER_DETAILS_NOT_IMPORTANT;
+
+        ASSERT_EQ(0, World::load(world_text).version);
+    }
+
+    TEST(World, load__visibility_on_big_maps) {
+        constexpr uint8_t x_size = 64;
+        constexpr uint8_t z_size = 64;
+
+        std::stringstream world_text;
+        world_text << "x " << (int) x_size << "\n" << "z " << (int) z_size << "\n" << CELL_SIZE_NOT_IMPORTANT;
+        for (uint8_t z = 0; z < z_size; ++z) {
+            std::string row(x_size, z % 4 == 2 ? '#' : '.');  // Corridors, with a door on alternate sides.
+            if (z % 4 == 2)
+                row[z % 8 == 2 ? 0 : x_size - 1] = '.';
+            if (z % 4 == 0)
+                row[z] = 'E';
+            if (z == 0)
+                row[5] = 'P';
+            world_text << row << "\n";
+        }
+        world_text << PLAYER_DETAILS_NOT_IMPORTANT;
+
+        const World w = World::load(world_text);
+
+        ASSERT_FALSE(w.visibility.empty());
+        ASSERT_NE(std::string::npos, w.visibility.report().find("tested"));
+    }
+
     // TODO: test what happens if grid test goes outside grid size. Or if the grid is missing, has holes (\n\n) etc.
     // TODO: try to comment in the stream. Use ; as a separator (saves # for the walls and it is the assembler convention).
 }
\ No newline at end of file
@@ -1,8 +1,18 @@
 #include "UserInterface.h"
 
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
 #include <stdexcept>
 
+#include "FixedProjectionPlane.h"
+#include "FixedTimestep.h"
 #include "ProjectionPlane.h"
+#include "ResolutionGovernor.h"
+#include "Shading.h"
+#include "Texture.h"
 
 #include "Timer.h"
 
@@ -18,29 +28,61 @@ namespace rc {
 			throw std::runtime_error(SDL_GetError());
 	}
 
-	Image::Image(const std::string& file_path, SDL_Renderer* renderer)
-	{
-		surface = SDL_LoadBMP(file_path.c_str());  // Assuming it handles bad files.
+	/** Loads the file and copies the pixels in the format that the core classes understand. */
+	static Texture load_bmp(const std::string& file_path) {
+		SDL_Surface* surface = SDL_LoadBMP(file_path.c_str());  // Assuming it handles bad files.
 		sdl_null_check(surface);
 
-		texture = SDL_CreateTextureFromSurface(renderer, surface);
-		sdl_null_check(texture);
+		SDL_Surface* argb_surface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+		SDL_FreeSurface(surface);
+		sdl_null_check(argb_surface);
+
+		std::vector<uint32_t> pixels;
+		pixels.reserve(argb_surface->w * argb_surface->h);
+		for (int row = 0; row < argb_surface->h; ++row) {
+			const Uint32* row_pixels = (const Uint32*)((const Uint8*)argb_surface->pixels + row * argb_surface->pitch);
+			pixels.insert(pixels.end(), row_pixels, row_pixels + argb_surface->w);
+		}
+
+		const uint16_t width = argb_surface->w;
+		const uint16_t height = argb_surface->h;
+		SDL_FreeSurface(argb_surface);
+
+		return Texture(width, height, std::move(pixels));
+	}
+
+	Image::Image(const ShadedTexture& pixels, SDL_Renderer* renderer) :
+		width(pixels.width),
+		height(pixels.height),
+		light_levels(pixels.light_levels),
+		mip_levels(pixels.mip_levels)
+	{
+		for (const Texture& level : pixels.variants) {
+			SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, level.width, level.height);
+			sdl_null_check(texture);
+			variants.push_back(texture);
+
+			sdl_return_check(SDL_UpdateTexture(texture, nullptr, level.pixels.data(), level.width * sizeof(uint32_t)));
+			sdl_return_check(SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND));  // SDL_CreateTextureFromSurface did it for us.
+		}
 	}
 
 	Image::~Image()
 	{
 		// SDL can handle the nullptrs, but the docs says it would set an error message.
 		// Do it by hand and leave it clean.
-		if (texture) SDL_DestroyTexture(texture);
-		if (surface) SDL_FreeSurface(surface);
+		for (SDL_Texture* texture : variants)
+			SDL_DestroyTexture(texture);
 	}
 
 	Image::Image(Image&& other) noexcept:
-		surface(other.surface),
-		texture(other.texture)
+		width(other.width),
+		height(other.height),
+		light_levels(other.light_levels),
+		mip_levels(other.mip_levels),
+		variants(std::move(other.variants))
 	{
-		other.surface = nullptr;
-		other.texture = nullptr;
+		other.variants.clear();
 	}
 
 	Image& Image::operator=(Image&& other) noexcept
@@ -48,135 +90,64 @@ namespace rc {
 		if (this == &other)
 			return *this;
 
-		this->surface = other.surface;
-		this->texture = other.texture;
+		this->width = other.width;
+		this->height = other.height;
+		this->light_levels = other.light_levels;
+		this->mip_levels = other.mip_levels;
+		this->variants = std::move(other.variants);
 
-		other.surface = nullptr;
-		other.texture = nullptr;
+		other.variants.clear();
 
 		return *this;
 	}
 
-
-	/** Implementation stolen from https://stackoverflow.com/questions/53033971/how-to-get-the-color-of-a-specific-pixel-from-sdl-surface. */
-	bool Image::transparent_pixel(const uint8_t x, const uint8_t y) const
+	SDL_Texture* Image::variant(const uint8_t light_level, const uint8_t mip) const noexcept
 	{
-		const Uint8 bpp = surface->format->BytesPerPixel;
-		const Uint8* pixel = (Uint8*) surface->pixels + y * surface->pitch + x * bpp;
-
-		Uint32 pixel_value = 0;
-		switch (bpp)
-		{
-		case 1:
-			pixel_value = *pixel;
-			break;
-		case 2:
-			pixel_value = *(Uint16*) pixel;
-			break;
-		case 3:
-			pixel_value = (SDL_BYTEORDER == SDL_BIG_ENDIAN) ?
-					pixel[0] << 16 | pixel[1] << 8 | pixel[2] :
-					pixel[0] | pixel[1] << 8 | pixel[2] << 16;
-			break;
-		case 4:
-			pixel_value = *(Uint32*) pixel;
-			break;
-		default:
-			throw std::runtime_error("Impossible bit per pixel.");
-		}
-
-		uint8_t r, g, b;
-		uint8_t alpha;
-		SDL_GetRGBA(pixel_value, surface->format, &r, &g, &b, &alpha);
-
-		return alpha < 128;
+		const uint8_t available_level = std::min(light_level, (uint8_t) (light_levels - 1));
+		const uint8_t available_mip = std::min(mip, (uint8_t) (mip_levels - 1));
+		return variants[(size_t) available_level * mip_levels + available_mip];
 	}
 
 
-	Sound::Sound(const std::string& file_path) {
-		wav_buffer = nullptr;
-		buffer_length = 0;
-		buffer_position = 0;
-		memset(&sound_spec, 0, sizeof(SDL_AudioSpec));
-
-		const SDL_AudioSpec* return_value = SDL_LoadWAV(
-			file_path.c_str(),
-			&sound_spec,
-			&wav_buffer,
-			&buffer_length);
-		sdl_null_check(return_value);
-	}
-
-	Sound::Sound(Sound&& other) noexcept :
-		sound_spec(other.sound_spec),
-		buffer_length(other.buffer_length),
-		wav_buffer(other.wav_buffer),
-		buffer_position(other.buffer_position)
-	{
-		// No idea about how to reset a sound spec.
-		other.buffer_length = 0;
-		other.wav_buffer = nullptr;
-	}
-
-	Sound& Sound::operator=(Sound&& other) noexcept
-	{
-		if (this == &other)
-			return *this;
-
-		sound_spec = other.sound_spec;
-		buffer_length = other.buffer_length;
-		buffer_position = other.buffer_position;
-		wav_buffer = other.wav_buffer;
-
-		// No idea about how to reset a sound spec.
-		other.buffer_length = 0;
-		other.wav_buffer = nullptr;
-
-		return *this;
-	}
+	/** The wav, converted to the format of the device (see AudioClip): the mixer never converts
+	anything while playing, and the mono tracks play as well as the stereo ones. */
+	static AudioClip load_clip(const std::string& file_path) {
+		SDL_AudioSpec file_spec;
+		Uint8* wav_buffer = nullptr;
+		Uint32 wav_length = 0;
+		sdl_null_check(SDL_LoadWAV(file_path.c_str(), &file_spec, &wav_buffer, &wav_length));
+
+		SDL_AudioCVT conversion;
+		const int needs_conversion = SDL_BuildAudioCVT(&conversion,
+			file_spec.format, file_spec.channels, file_spec.freq,
+			AUDIO_S16SYS, 2, UserInterface::AUDIO_FREQUENCY);
+		if (needs_conversion < 0) {
+			SDL_FreeWAV(wav_buffer);
+			throw std::runtime_error(SDL_GetError());
+		}
 
-	Sound::~Sound() {
+		// SDL converts in place, in a buffer that may have to be bigger than the file data.
+		std::vector<Uint8> converted((size_t) wav_length * conversion.len_mult);
+		std::memcpy(converted.data(), wav_buffer, wav_length);
 		SDL_FreeWAV(wav_buffer);
-	}
-
-
-	bool Sound::mix_next_chunk(const uint32_t len, Uint8* stream, const uint8_t volume, const Repetition loop)
-	{
-		const bool looping_sound = (loop == Repetition::LOOP);
-
-		uint32_t copied = 0;
-		bool end_of_sound = false;
-
-		int loops = 0;
 
-		/* In case we are near the end of the buffer (or there is a very, very short sound) there may 
-		not be enough data to copy. In this case, loop on the buffer (if the sound is looping) to fill
-		the requested data. */
-		while (copied < len)
-		{
-			loops++;
-
-			const uint32_t left_in_buffer = buffer_length - buffer_position;
-			const uint32_t copy_length = std::min(left_in_buffer, len);
-
-			SDL_MixAudio(stream, wav_buffer + buffer_position, copy_length, volume);
-			buffer_position += copy_length;
-			copied += copy_length;
-
-			end_of_sound = buffer_position >= buffer_length;
-			if (end_of_sound) {
-				rewind();
-				
-				if (!looping_sound)
-					break;
-			}
+		size_t converted_length = wav_length;
+		if (needs_conversion) {
+			conversion.buf = converted.data();
+			conversion.len = (int) wav_length;
+			sdl_return_check(SDL_ConvertAudio(&conversion));
+			converted_length = conversion.len_cvt;
 		}
 
-		return end_of_sound && (! looping_sound);  // Looping sounds never really end.
+		AudioClip clip;
+		clip.samples.resize(converted_length / sizeof(int16_t));
+		std::memcpy(clip.samples.data(), converted.data(), clip.samples.size() * sizeof(int16_t));
+		return clip;
 	}
 
-	void Sound::rewind() noexcept {
-		buffer_position = 0;
+	static bool is_music(const SoundIndex sound) noexcept {
+		return sound == SoundIndex::MUSIC_CALM || sound == SoundIndex::MUSIC_SLOW ||
+			sound == SoundIndex::MUSIC_MID || sound == SoundIndex::MUSIC_FAST;
 	}
 
 
@@ -185,17 +156,29 @@ namespace rc {
 		main_window(nullptr),
 		main_window_surface(nullptr),
 		renderer(nullptr),
+		background(nullptr),
+		scene(nullptr),
 		halt_game_loop(true),  // Safe default.
 		pause_game_loop(false),
 		endgame(false),
-		sfx_sound(SoundIndex::SILENCE)
+		scene_version(0),
+		scene_camera{ 0, 0, 0 },
+		scene_columns(0),
+		published_music(SoundIndex::SILENCE),
+		playing_music(SoundIndex::SILENCE),
+		mixer(AUDIO_VOICES, AUDIO_BLOCK_FRAMES)
 	{
 	}
 
 	UserInterface::~UserInterface()
 	{
 		SDL_CloseAudio();
+		music_refiller.reset();  // Nobody takes from the streams any more, stop reading them.
 
+		if (background)
+			SDL_DestroyTexture(background);
+		if (scene)
+			SDL_DestroyTexture(scene);
 		SDL_DestroyRenderer(renderer);
 		SDL_DestroyWindow(main_window);
 		SDL_Quit();
@@ -203,25 +186,27 @@ namespace rc {
 
 
 	void UserInterface::audio_callback(void* userdata, Uint8* stream, int len) {
-		// TODO: check null pointers.
-		
-		// Clean up the buffer. TODO: may avoid by copying the bacground music.
-		memset(stream, 0, len);
-
 		UserInterface* ui = (UserInterface*)userdata;
 
-		// The music always continues, even when the game is paused.
-		// Intentionally ignoring the case of pauses in the middle of a gun shot.
-		const SoundIndex background_music = ui->world.music.select_music_score(ui->world.sprites, ui->world.player);  //TODO: breaks the dependency inversion?
-		const bool loop_background = ui->sounds.at(background_music).mix_next_chunk(len, stream, 120, Sound::Repetition::LOOP);
-		
-		if (ui->sfx_sound != SoundIndex::SILENCE) {
-			Sound& sound_effect = ui->sounds.at(ui->sfx_sound);
-			const bool sfx_finished = sound_effect.mix_next_chunk(len, stream, 10, Sound::Repetition::ONCE);  // TODO: hardcoded volumes!
-			if (sfx_finished) {
-				ui->sfx_sound = SoundIndex::SILENCE;
+		AudioCommand command;
+		while (ui->audio_commands.pop(command))
+			if (command.kind == AudioCommand::Kind::CHANGE_MUSIC) {
+				// The music always continues, even when the game is paused: only the gains change.
+				const auto old_voice = ui->music_voices.find(ui->playing_music);
+				if (old_voice != ui->music_voices.end())
+					ui->mixer.set_gain(old_voice->second, 0, 0);
+
+				ui->playing_music = command.sound;
+				const auto new_voice = ui->music_voices.find(ui->playing_music);
+				if (new_voice != ui->music_voices.end())
+					ui->mixer.set_gain(new_voice->second, command.gain, command.pan);
 			}
-		}
+			else if (command.sound != SoundIndex::SILENCE)
+				// A new voice for every shot: the bursts overlap instead of cutting each other.
+				ui->mixer.play(ui->sounds.at(command.sound), command.gain, command.pan, AudioMixer::Repetition::ONCE);
+
+		// The mixer writes every frame of the stream, silence included.
+		ui->mixer.mix(reinterpret_cast<int16_t*>(stream), (uint32_t) len / (2 * sizeof(int16_t)));
 	}
 
 
@@ -243,73 +228,137 @@ namespace rc {
 		renderer = SDL_CreateRenderer(main_window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
 		sdl_null_check(renderer);
 
-		Sound& reference_sound = const_cast<Sound&>(sounds.at(SoundIndex::MUSIC_CALM));  // TODO: must avoid... This assumes all the sounds have the same specs, of course. Check SDL_ConvertAudio(), it may help.
-		reference_sound.sound_spec.callback = UserInterface::audio_callback;
-		reference_sound.sound_spec.userdata = this;
-		if (SDL_OpenAudio(&(reference_sound.sound_spec), NULL) < 0)  // TODO: replace with https://wiki.libsdl.org/SDL_OpenAudioDevice
+		background = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+			UserInterface::SCREEN_WIDTH, UserInterface::SCREEN_HEIGHT);
+		sdl_null_check(background);
+		background_pixels.resize(UserInterface::SCREEN_WIDTH * UserInterface::SCREEN_HEIGHT);
+
+		scene = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+			UserInterface::SCREEN_WIDTH, UserInterface::SCREEN_HEIGHT);
+		sdl_null_check(scene);
+
+		SDL_AudioSpec device_spec;
+		memset(&device_spec, 0, sizeof(SDL_AudioSpec));
+		device_spec.freq = UserInterface::AUDIO_FREQUENCY;
+		device_spec.format = AUDIO_S16SYS;
+		device_spec.channels = 2;
+		device_spec.samples = UserInterface::AUDIO_BLOCK_FRAMES;
+		device_spec.callback = UserInterface::audio_callback;
+		device_spec.userdata = this;
+		if (SDL_OpenAudio(&device_spec, NULL) < 0)  // NULL: SDL converts to the real device format if it differs.
 			throw std::runtime_error(SDL_GetError());
+
+		// The audio thread does not run yet: no need of the queue.
+		published_music = world.music.select_music_score(world.sprites, world.player);
+		playing_music = published_music;
+
+		// Every track loops from the start, the ones not selected without gain: switching is just a change of gains.
+		std::vector<MusicStream*> streams;
+		for (const auto& track : music) {
+			music_voices[track.first] = mixer.play(*track.second, track.first == playing_music ? MUSIC_GAIN : 0, 0);
+			streams.push_back(track.second.get());
+		}
+		music_refiller = std::make_unique<StreamRefiller>(streams, std::chrono::milliseconds(MUSIC_REFILL_MS));
+
 		SDL_PauseAudio(0);  // start playing immediately. TODO: pause audio... device.
 	}
 	
-	void UserInterface::poll_input()
+	void UserInterface::poll_input(const bool wait_for_input)
 	{
-		Player& player = world.player;
-		const Grid& map = world.map;
-
+		// Nothing moves until some input comes: sleep in SDL instead of spinning on the loop.
 		SDL_Event user_input;
-		while (SDL_PollEvent(&user_input) != 0)
-			if (user_input.type == SDL_QUIT)
-				halt_game_loop = true;
-			else if (user_input.type == SDL_KEYDOWN) {
-				if (user_input.key.keysym.scancode == SDL_SCANCODE_P && ! endgame)
-					pause_game_loop = !pause_game_loop;
-				else if (user_input.key.keysym.scancode == SDL_SCANCODE_ESCAPE)
-					halt_game_loop = true;
-				else if (user_input.key.keysym.scancode == SDL_SCANCODE_SPACE && !pause_game_loop)
-					// Cheap way out to avoid a cooldown timer on the shoot key. Using the key state
-					// would cause a shot per frame (too fast).
-					player.shoot(map, world.sprites, *this, *this);
-			}
+		bool pending_event = wait_for_input ?
+			SDL_WaitEventTimeout(&user_input, UserInterface::IDLE_WAIT_MS) != 0 :
+			SDL_PollEvent(&user_input) != 0;
+		while (pending_event) {
+			handle_event(user_input);
+			pending_event = SDL_PollEvent(&user_input) != 0;
+		}
+	}
 
-		if (pause_game_loop || endgame)
-			return;
-			// Ignore any other input.
-		    // TODO: this causes a CPU usage spike! Probably it is furiously polling the input.
-		
+	void UserInterface::move_player(const float seconds)
+	{
+		Player& player = world.player;
+		const Camera before_input = player.camera();
 
 		// Intentionally ignore nonsensical key combos (e. g. up and down at the same time).
 		const Uint8* key_states = SDL_GetKeyboardState(nullptr);
 		if (key_states[SDL_SCANCODE_UP])
-			player.advance(1, map);
+			player.advance(1, seconds, world.map);
 		else if (key_states[SDL_SCANCODE_DOWN])
-			player.advance(-1, map);
+			player.advance(-1, seconds, world.map);
 		
 		if (key_states[SDL_SCANCODE_LEFT])
-			player.turn(-1);
+			player.turn(-1, seconds);
 		else if (key_states[SDL_SCANCODE_RIGHT])
-			player.turn(+1);
+			player.turn(+1, seconds);
+
+		if (player.camera() != before_input)
+			++world.version;  // Pressing against a wall moves nothing.
 	}
 
-	void UserInterface::draw_background() {
-		int rc = 0;
+	bool UserInterface::movement_keys_held() const
+	{
+		const Uint8* key_states = SDL_GetKeyboardState(nullptr);
+		return key_states[SDL_SCANCODE_UP] || key_states[SDL_SCANCODE_DOWN]
+			|| key_states[SDL_SCANCODE_LEFT] || key_states[SDL_SCANCODE_RIGHT];
+	}
 
-		rc = SDL_SetRenderDrawColor(renderer, 150, 150, 150, 255);
+	void UserInterface::handle_event(const SDL_Event& user_input)
+	{
+		Player& player = world.player;
+		const Grid& map = world.map;
+
+		if (user_input.type == SDL_QUIT)
+			halt_game_loop = true;
+		else if (user_input.type == SDL_KEYDOWN) {
+			if (user_input.key.keysym.scancode == SDL_SCANCODE_P && ! endgame)
+				pause_game_loop = !pause_game_loop;
+			else if (user_input.key.keysym.scancode == SDL_SCANCODE_ESCAPE)
+				halt_game_loop = true;
+			else if (user_input.key.keysym.scancode == SDL_SCANCODE_SPACE && !pause_game_loop) {
+				// Cheap way out to avoid a cooldown timer on the shoot key. Using the key state
+				// would cause a shot per frame (too fast).
+				player.shoot(map, world.sprites, world.masks, *this,
+					world.visibility.objects_visible_from(map.cell_of(player.x_position, player.z_position)));
+				++world.version;  // At least a bullet less on the HUD.
+			}
+		}
+	}
+
+	void UserInterface::draw_background(const FloorCaster& floor_caster, const Camera& camera) {
+		floor_caster.cast(camera, background_pixels.data(), UserInterface::SCREEN_WIDTH);
+
+		const SDL_Rect cast_area{ 0, 0, floor_caster.columns, floor_caster.rows };
+		int rc = SDL_UpdateTexture(background, &cast_area, background_pixels.data(), UserInterface::SCREEN_WIDTH * sizeof(uint32_t));
 		sdl_return_check(rc);
-		
-		rc = SDL_RenderClear(renderer);
+
+		rc = SDL_RenderCopy(renderer, background, &cast_area, &cast_area);
+		sdl_return_check(rc);
+	}
+
+	void UserInterface::draw_scene(ProjectionPlane& projection, const FloorCaster& floor_caster, const Camera& camera) {
+		int rc = SDL_SetRenderTarget(renderer, scene);
 		sdl_return_check(rc);
 
-		// Draw the floor darker than the ceiling and the texture. It looks better.
-		rc = SDL_SetRenderDrawColor(renderer, 80, 80, 80, 255);
+		draw_background(floor_caster, camera);
+		projection.project_objects(world, camera, *this);
+
+		rc = SDL_SetRenderTarget(renderer, nullptr);
 		sdl_return_check(rc);
 
-		SDL_Rect half_screen;
-		half_screen.x = 0;
-		half_screen.y = UserInterface::SCREEN_HEIGHT / 2;
-		half_screen.h = UserInterface::SCREEN_HEIGHT / 2;
-		half_screen.w = UserInterface::SCREEN_WIDTH;
+		scene_version = world.version;
+		scene_camera = camera;
+		scene_columns = projection.columns;
+		show_scene();
+	}
+
+	void UserInterface::show_scene() {
+		if (scene_columns == 0)
+			return;  // Paused before the first frame: nothing to show.
 
-		rc = SDL_RenderFillRect(renderer, &half_screen);
+		const SDL_Rect cast_area{ 0, 0, scene_columns, UserInterface::SCREEN_HEIGHT };
+		const int rc = SDL_RenderCopy(renderer, scene, &cast_area, nullptr);
 		sdl_return_check(rc);
 	}
 
@@ -320,31 +369,79 @@ namespace rc {
 
 	void UserInterface::game_loop()
 	{
-		ProjectionPlane projection(UserInterface::SCREEN_WIDTH, UserInterface::SCREEN_HEIGHT, 60);
+		// All the levels are prepared here, switching between them costs nothing during the game.
+		ResolutionGovernor governor({ 640, 512, 400, 320, 256, 200, 160 }, UserInterface::FRAME_BUDGET_MS);
+		// The full resolution is the one of the window, known at compile time: it gets the precomputed plane.
+		std::vector<std::unique_ptr<ProjectionPlane>> projections;
+		std::vector<FloorCaster> floor_casters;
+		floor_casters.reserve(governor.column_levels.size());
+		for (const uint16_t columns : governor.column_levels) {
+			if (columns == UserInterface::SCREEN_WIDTH)
+				projections.push_back(std::make_unique<FixedProjectionPlane<UserInterface::SCREEN_WIDTH, UserInterface::SCREEN_HEIGHT, UserInterface::FOV_DEGREES>>());
+			else
+				projections.push_back(std::make_unique<ProjectionPlane>(columns, UserInterface::SCREEN_HEIGHT, UserInterface::FOV_DEGREES, UserInterface::SCREEN_WIDTH));
+
+			ProjectionPlane& projection = *projections.back();
+			projection.wall_drawing = ProjectionPlane::WallDrawing::SPANS;
+			projection.wall_sampling = ProjectionPlane::WallSampling::ADAPTIVE;
+			projection.view_distance = 24.0f * world.map.cell_size;  // About where the shading is already the darkest.
+			projection.fog = true;
+			floor_casters.emplace_back(projection, world.map.cell_size, surfaces.at(TextureIndex::FLOOR), surfaces.at(TextureIndex::CEILING));
+		}
 
 		//Timer rendering_timer; //Intentionally commented out - occasionally used to profile.
+
+		FixedTimestep simulation(UserInterface::SIMULATION_STEP_SECONDS, UserInterface::MAX_SIMULATION_STEPS);
+		Camera previous_camera = world.player.camera();  // Before the last step of the simulation.
+		uint64_t last_frame = SDL_GetPerformanceCounter();
 		
 		halt_game_loop = false;
 		while (! halt_game_loop) {
-			poll_input();
+			// Paused, game over or a player that does nothing: the last frame is still good until some input.
+			const bool scene_up_to_date = scene_columns != 0 && scene_version == world.version && scene_camera == world.player.camera();
+			const bool wait_for_input = pause_game_loop || endgame || (scene_up_to_date && !movement_keys_held());
+			poll_input(wait_for_input);
 
 			if (halt_game_loop) {
 				//rendering_timer.dump("Rendering");
 				return;
 			}
 
+			// The time asleep waiting for input is not game time.
+			const uint64_t now = SDL_GetPerformanceCounter();
+			const float elapsed_seconds = wait_for_input ? 0 : (float) (now - last_frame) / SDL_GetPerformanceFrequency();
+			last_frame = now;
+
+			if (!pause_game_loop && !endgame)
+				for (uint8_t steps = simulation.steps_for(elapsed_seconds); steps > 0; --steps) {
+					previous_camera = world.player.camera();
+					move_player(simulation.step_seconds);
+				}
+			const Camera camera = interpolate(previous_camera, world.player.camera(), simulation.interpolation());
+			publish_music();
+
+			// The content of the window after a present is undefined: every frame starts from the scene.
 			if (pause_game_loop) {
+				show_scene();
 				world.hud.alert_pause(*this);
 			}
 			else if (world.endgame()) {
+				show_scene();
 				world.hud.alert_endgame(*this);
 				endgame = true;
 			}
 			else
 			{
-				//rendering_timer.start();
-				draw_background();
-				projection.project_objects(world, *this);
+				if (scene_columns == 0 || scene_version != world.version || scene_camera != camera) {
+					//rendering_timer.start();
+					const uint64_t scene_start = SDL_GetPerformanceCounter();
+					const uint8_t level = governor.level();
+					draw_scene(*projections[level], floor_casters[level], camera);
+					governor.frame_rendered(1000.0f * (SDL_GetPerformanceCounter() - scene_start) / SDL_GetPerformanceFrequency());
+				}
+				else
+					show_scene();  // Same world, same picture: no need to draw it again.
+
 				draw_debug_crosshair();
 				world.hud.display(world.player, *this);
 				//rendering_timer.end();
@@ -357,39 +454,121 @@ namespace rc {
 
 	void UserInterface::set_texture(const TextureIndex name, const std::string& file_path)
 	{
-		textures.emplace(name, Image(file_path, renderer));
+		const Texture pixels = load_bmp(file_path);
+
+		if (name == TextureIndex::FLOOR || name == TextureIndex::CEILING) {
+			surfaces.erase(name);
+			surfaces.emplace(name, ShadedTexture(pixels, LIGHT_LEVELS));
+			return;
+		}
+
+		// Only what is in the 3D view gets darker with the distance.
+		const bool in_the_scene = name == TextureIndex::WALL || name == TextureIndex::ENEMY || name == TextureIndex::EXIT;
+		textures.emplace(name, Image(ShadedTexture(pixels, in_the_scene ? LIGHT_LEVELS : 1), renderer));
+		world.masks.set(name, AlphaMask(pixels));  // The game logic needs to know what is solid, without asking SDL.
 	}
 
 	void UserInterface::set_sound(const SoundIndex name, const std::string& file_path)
 	{
-		sounds.emplace(name, Sound(file_path));
+		if (!is_music(name)) {
+			sounds.emplace(name, load_clip(file_path));
+			return;
+		}
+
+		auto file = std::make_unique<std::ifstream>(file_path, std::ios::binary);
+		if (!file->is_open())
+			throw std::runtime_error("Can not open " + file_path);
+
+		auto stream = std::make_unique<MusicStream>(std::move(file), MUSIC_BUFFER_FRAMES);
+		if (stream->frequency() != AUDIO_FREQUENCY)
+			throw std::runtime_error("The music is streamed without resampling, it must be at 44100 Hz: " + file_path);
+		music.emplace(name, std::move(stream));
 	}
 
-	void UserInterface::draw_slice(const uint16_t column, const int16_t top_row, const uint16_t height, const uint16_t texture_offset, const TextureIndex what_to_draw)
+	void UserInterface::draw_slice(const uint16_t column, const SliceProjection& slice, const uint16_t texture_offset, const TextureIndex what_to_draw)
 	{
+		if (slice.height == 0)
+			return;
+
 		const Image& texture = textures.at(what_to_draw);
 
+		// Assume widht and height match. Draw from the mipmap that has (about) as many pixels as the full slice.
+		const uint16_t texture_size = texture.width;
+		const float full_height = std::min(texture_size / slice.texture_step, (float) std::numeric_limits<uint16_t>::max());
+		const uint8_t level = mip_level(texture_size, (uint16_t) full_height, texture.mip_levels);
+		const float level_scale = 1.0f / (1 << level);
+
+		// SDL wants whole texels. Take all the texels that are even partially visible, then shift the
+		// destination up by the fraction of texel that should be hidden. The overflow is never
+		// bigger than one texel, the renderer clips it.
+		const float texels_per_row = slice.texture_step * level_scale;
+		const float first_texel = slice.texture_top * level_scale;
+		const float last_texel = first_texel + slice.height * texels_per_row;
+		const int source_top = (int) std::floor(first_texel);
+		const int source_bottom = (int) std::ceil(last_texel);
+
 		SDL_Rect source_slice;
-		source_slice.x = texture_offset;
-		source_slice.y = 0;
+		source_slice.x = texture_offset >> level;
+		source_slice.y = source_top;
 		source_slice.w = 1;
-		source_slice.h = texture.surface->w;  // Assume widht and height match.
+		source_slice.h = source_bottom - source_top;
 
-		SDL_Rect dest_slice;
+		SDL_FRect dest_slice;
 		dest_slice.x = column;
-		dest_slice.y = top_row;
+		dest_slice.y = slice.top_row - (first_texel - source_top) / texels_per_row;
 		dest_slice.w = 1;
-		dest_slice.h = height;
+		dest_slice.h = source_slice.h / texels_per_row;
 
-		const int rc = SDL_RenderCopy(renderer, texture.texture, &source_slice, &dest_slice);  // TODO Or maybe I have to use SDL_BlitSurface?
+		const int rc = SDL_RenderCopyF(renderer, texture.variant(slice.light_level, level), &source_slice, &dest_slice);
 		sdl_return_check(rc);
 	}
 
 
-	// TODO: can I avoid this indirection? "Link" the image into the sprites?
-	bool UserInterface::transparent_pixel(const uint8_t x, const uint8_t y, const TextureIndex image) const
+	void UserInterface::draw_span(const WallSpan& span, const TextureIndex what_to_draw)
 	{
-		return textures.at(image).transparent_pixel(x, y);
+		// Walls so close that they are much taller than the screen: the vertices would be too far away for
+		// the float precision of the clipping. Those are few columns anyway.
+		constexpr float max_quad_height = 4 * UserInterface::SCREEN_HEIGHT;
+		if (span.first_column == span.last_column || std::max(span.first_height, span.last_height) > max_quad_height) {
+			for (uint16_t column = span.first_column; column <= span.last_column; ++column) {
+				const uint16_t texture_offset = (uint16_t) std::min(std::max(span.offset_at(column), 0.0f), span.object_size - 1.0f);
+				draw_slice(column, span.slice_at(column, UserInterface::SCREEN_HEIGHT), texture_offset, what_to_draw);
+			}
+			return;
+		}
+
+		const Image& texture = textures.at(what_to_draw);
+		const float tallest = std::max(span.first_height, span.last_height);
+		const uint8_t level = mip_level(texture.width, (uint16_t) tallest, texture.mip_levels);
+
+		// Vertices on the left border of every few columns, and on the right border of the last one.
+		constexpr uint16_t columns_per_quad = 16;
+		const float horizon = UserInterface::SCREEN_HEIGHT / 2.0f;
+		const SDL_Color no_tint = { 255, 255, 255, 255 };
+
+		span_vertices.clear();
+		span_indices.clear();
+		const uint16_t end_column = span.last_column + 1;
+		for (uint16_t column = span.first_column; ; column = std::min<uint16_t>(column + columns_per_quad, end_column)) {
+			const float half_height = span.height_at(column) / 2;
+			const float u = span.offset_at(column) / span.object_size;
+
+			span_vertices.push_back(SDL_Vertex{ SDL_FPoint{ (float) column, horizon - half_height }, no_tint, SDL_FPoint{ u, 0 } });
+			span_vertices.push_back(SDL_Vertex{ SDL_FPoint{ (float) column, horizon + half_height }, no_tint, SDL_FPoint{ u, 1 } });
+
+			if (span_vertices.size() >= 4) {
+				const int top_right = (int) span_vertices.size() - 2;
+				const int top_left = top_right - 2;
+				span_indices.insert(span_indices.end(), { top_left, top_left + 1, top_right, top_right, top_left + 1, top_right + 1 });
+			}
+
+			if (column == end_column)
+				break;
+		}
+
+		const int rc = SDL_RenderGeometry(renderer, texture.variant(span.light_level, level),
+			span_vertices.data(), (int) span_vertices.size(), span_indices.data(), (int) span_indices.size());
+		sdl_return_check(rc);
 	}
 
 
@@ -401,23 +580,15 @@ namespace rc {
 	void UserInterface::draw_text(const std::string& text, uint16_t column, const uint16_t row, const uint8_t font_size)
 	{
 		constexpr uint8_t source_letter_side = 8;
-		constexpr uint8_t last_char_bitmap = 64;
 
 		const Image& texture = textures.at(TextureIndex::FONT);
 		uint16_t cursor = column;
 
 		// Remap the ASCII code to the bitmap position.
-		for (char c : text) {
-			if ('A' <= c && c <= 'Z')
-				c = c - 'A' + 18;  // Letters starts after digits and some spave and 'A' is the 1st letter in the bitmap.
-			else if ('0' <= c && c <= ':')  // The ':' is just after '9' in ASCII.
-				c -= '0';
-			else if (c == '!')
-				c = 44; // I know where this is on the bitmap...
-			else //Space or unsupported char, skip and leave a space.
-				c = last_char_bitmap + 1;
-
-			if (c < last_char_bitmap) {
+		for (const char letter : text) {
+			const int8_t c = font_glyph(letter);
+
+			if (c >= 0) {  // Space or unsupported char, skip and leave a space.
 				// Compute char position in terms of pixels in the bitmap.
 				const uint8_t font_row = c / source_letter_side * source_letter_side;
 				const uint8_t font_column = c % source_letter_side * source_letter_side;
@@ -434,7 +605,7 @@ namespace rc {
 				dest_slice.w = font_size;
 				dest_slice.h = font_size;
 
-				const int rc = SDL_RenderCopy(renderer, texture.texture, &source_slice, &dest_slice);  // TODO Or maybe I have to use SDL_BlitSurface?
+				const int rc = SDL_RenderCopy(renderer, texture.variant(0, 0), &source_slice, &dest_slice);  // TODO Or maybe I have to use SDL_BlitSurface?
 				sdl_return_check(rc);
 			}
 			cursor += font_size;
@@ -448,27 +619,32 @@ namespace rc {
 		SDL_Rect source_slice;
 		source_slice.x = 0;
 		source_slice.y = 0;
-		source_slice.w = texture.surface->w;
-		source_slice.h = texture.surface->h;
+		source_slice.w = texture.width;
+		source_slice.h = texture.height;
 
 
 		// TODO: scale with the screen...
 		SDL_Rect dest_slice;
 		dest_slice.x = column_x;
 		dest_slice.y = row_y;
-		dest_slice.w = texture.surface->w;
-		dest_slice.h = texture.surface->h;
+		dest_slice.w = texture.width;
+		dest_slice.h = texture.height;
 
-		const int rc = SDL_RenderCopy(renderer, texture.texture, &source_slice, &dest_slice);  // TODO Or maybe I have to use SDL_BlitSurface?
+		const int rc = SDL_RenderCopy(renderer, texture.variant(0, 0), &source_slice, &dest_slice);  // TODO Or maybe I have to use SDL_BlitSurface?
 		sdl_return_check(rc);
 	}
 
 
 	void UserInterface::play_sound(const SoundIndex sound) {
-		sfx_sound = sound;
+		// Nothing to do if the queue is full: the audio thread is far behind, this sound would be late anyway.
+		audio_commands.push(AudioCommand{ AudioCommand::Kind::PLAY_EFFECT, sound, EFFECT_GAIN, 0 });
+	}
 
-		// Force the noise to start again if already playing. Makes for better burst shots.
-		sounds.at(sfx_sound).rewind();
+	void UserInterface::publish_music()
+	{
+		const SoundIndex music = world.music.select_music_score(world.sprites, world.player);
+		if (music != published_music && audio_commands.push(AudioCommand{ AudioCommand::Kind::CHANGE_MUSIC, music, MUSIC_GAIN, 0 }))
+			published_music = music;  // With the queue full, it tries again at the next frame.
 	}
 
 
@@ -1,21 +1,33 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <SDL.h>
 
+#include "Camera.h"
+#include "AudioMixer.h"
 #include "Canvas.h"
+#include "FloorCaster.h"
 #include "Loudspeaker.h"
+#include "MusicStream.h"
+#include "Shading.h"
+#include "SpscQueue.h"
+#include "StreamRefiller.h"
 #include "World.h"
 
 namespace rc {
 
 
-	/** Just a wrapper to hold the SDL structures for a texture and ensure RAII clean up. */
+	/** Just a wrapper to hold the SDL structures for a texture and ensure RAII clean up.
+	
+	The texture is uploaded with all its mipmaps and light levels, see ShadedTexture. Shading is then just
+	a matter of picking the right SDL texture, no color modulation. */
 	class Image {
 	public:
-		Image(const std::string& file_path, SDL_Renderer* renderer);
+		Image(const ShadedTexture& pixels, SDL_Renderer* renderer);
 		~Image();
 
 		/** Required to allow creation via STL containers emplace methods. */
@@ -24,11 +36,16 @@ namespace rc {
 		/** Required to allow creation via STL containers emplace methods. */
 		Image& operator=(Image&& other) noexcept;
 
-		/** Returns true if the pixel at the given coordinates has a small alpha. */
-		bool transparent_pixel(const uint8_t x, const uint8_t y) const;
+		/** Same clamping of ShadedTexture::variant. */
+		SDL_Texture* variant(const uint8_t light_level, const uint8_t mip) const noexcept;
+
+		uint16_t width;
+		uint16_t height;
+		uint8_t light_levels;
+		uint8_t mip_levels;
 
-		SDL_Surface* surface;
-		SDL_Texture* texture;
+		/** Same order of ShadedTexture::variants. */
+		std::vector<SDL_Texture*> variants;
 	
 	private:
 		// Avoid copy, would make a mess with the pointers.
@@ -37,40 +54,20 @@ namespace rc {
 	};
 
 
-	/** RAII wrapper around the SDL sound data. */
-	class Sound {
-	public:
-		enum class Repetition : uint8_t {
-			LOOP,
-			ONCE
+	/** What the game thread asks to the audio callback. */
+	struct AudioCommand {
+		enum class Kind : uint8_t {
+			PLAY_EFFECT,  /// From the beginning, instead of the effect playing now.
+			CHANGE_MUSIC  /// All the tracks always play: the new one only gets the gain, the old one loses it.
 		};
 
-		Sound(const std::string& file_path);
-		~Sound();
-
-		/** Copy the sound data in the stream, attempting to fill the given length. */
-		bool mix_next_chunk(const uint32_t len, Uint8* stream, const uint8_t volume, const Repetition loop);
-
-		/** Restart playing the sound from the beginning. */
-		void rewind() noexcept;
-
-		/** Required to allow creation via STL containers emplace methods and avoid extra deletes of the stored pointers. */
-		Sound(Sound&& other) noexcept;
-
-		/** Required to allow creation via STL containers emplace methods and avoid extra deletes of the stored pointers. */
-		Sound& operator=(Sound&& other) noexcept;
-
-		SDL_AudioSpec sound_spec;  /// Public because needed to open devices.
-	
-		uint8_t* wav_buffer;  // Public to pass it into SDL.
-			
-	private:
-		uint32_t buffer_length;
-		uint32_t buffer_position;
-		
-
+		Kind kind;
+		SoundIndex sound;
+		float gain;  /// See AudioMixer::play.
+		float pan;
 	};
 
+
 	/** This class is the entry point to visualize things and react to keys.
 	    "Glues" the SDL calls and the rest of the game, ensures RAII handling of the SDL
 		data.
@@ -84,6 +81,32 @@ namespace rc {
 		static constexpr int SCREEN_WIDTH = 640;
 		static constexpr int SCREEN_HEIGHT = 480;
 
+		/** Time for the floor, walls and sprites of a frame. Above it the governor casts fewer columns. */
+		static constexpr float FRAME_BUDGET_MS = 10;
+		static constexpr uint8_t FOV_DEGREES = 60;
+
+		/** Longest sleep waiting for input when nothing moves (paused, game over, player idle).
+		The loop wakes up earlier for any event. */
+		static constexpr uint32_t IDLE_WAIT_MS = 250;
+
+		/** The game logic runs at this fixed rate, the frames come when they can (see FixedTimestep). */
+		static constexpr float SIMULATION_STEP_SECONDS = 1.0f / 60;
+		static constexpr uint8_t MAX_SIMULATION_STEPS = 8;  /// In a frame. Beyond, the game slows down.
+
+		/** The device plays 16 bit stereo at this rate. Every sound is converted to it when loaded. */
+		static constexpr int AUDIO_FREQUENCY = 44100;
+		static constexpr uint16_t AUDIO_BLOCK_FRAMES = 1024;  /// Asked to the device for each callback.
+		static constexpr uint8_t AUDIO_VOICES = 16;  /// The music tracks plus the effects playing together.
+
+		/** Same loudness of the old SDL_MixAudio volumes, 120 and 10 out of 128. */
+		static constexpr float MUSIC_GAIN = 120.0f / 128;
+		static constexpr float EFFECT_GAIN = 10.0f / 128;
+
+		/** Each music track keeps this much in memory (about a third of a second), whatever its length.
+		The refill thread tops the rings up every MUSIC_REFILL_MS. */
+		static constexpr uint32_t MUSIC_BUFFER_FRAMES = 16384;
+		static constexpr uint32_t MUSIC_REFILL_MS = 20;
+
 		/** Try not to create more than one! It instantiates SDL structures on creation.*/
 		UserInterface(World& world);
 		~UserInterface();
@@ -94,9 +117,11 @@ namespace rc {
 		void set_texture(const TextureIndex name, const std::string& file_path);
 		void set_sound(const SoundIndex name, const std::string& file_path);
 
-		void draw_slice(const uint16_t column, const int16_t top_row, const uint16_t height, const uint16_t texture_offset, const TextureIndex what_to_draw) final;
+		void draw_slice(const uint16_t column, const SliceProjection& slice, const uint16_t texture_offset, const TextureIndex what_to_draw) final;
 
-		bool transparent_pixel(const uint8_t x, const uint8_t y, const TextureIndex image) const final;
+		/** The span is cut in quads of few columns, all drawn with a single SDL_RenderGeometry call.
+		SDL interpolates the texture linearly on each quad, the perspective is correct only at the quad borders. */
+		void draw_span(const WallSpan& span, const TextureIndex what_to_draw) final;
 
 		void draw_text(const std::string& text, uint16_t column, const uint16_t row, const uint8_t font_size) final;
 
@@ -105,7 +130,7 @@ namespace rc {
 		void play_sound(const SoundIndex sound);
 
 	private:
-		World& world;  /// NO copy! Must live longer than the interface! Did not want to do this, but I need to keep a reference for the audio callback.
+		World& world;  /// NO copy! Must live longer than the interface!
 
 		SDL_Window* main_window;
 		SDL_Surface* main_window_surface;
@@ -115,27 +140,79 @@ namespace rc {
 		bool pause_game_loop;
 		bool endgame;
 
+		/** What is in the scene texture: the world version it shows (see World::version), from which camera,
+		and its width. No scene drawn yet when the columns are 0. */
+		uint32_t scene_version;
+		Camera scene_camera;
+		uint16_t scene_columns;
+
+		SDL_Texture* background;  /// Streaming texture where the floor and ceiling are cast.
+		SDL_Texture* scene;  /// Render target for the 3D view, as wide as the columns cast in the frame.
+		std::vector<uint32_t> background_pixels;
+
+		/** Kept between the draw_span calls only to avoid allocating them every time. */
+		std::vector<SDL_Vertex> span_vertices;
+		std::vector<int> span_indices;
+
 		std::unordered_map<TextureIndex, Image> textures;  //TODO: overkill. Textures are known at compile time -> use direct addressing array with TextureIndexes... as indexes. Also keep the image pointer in the sprites to avoid a lookup (but not a shared one, ownership is with the array...?)
-		std::unordered_map<SoundIndex, Sound> sounds;  //TODO: overkill. Sounds are known at compile time -> use direct addressing array with TextureIndexes... as indexes. Also keep the image pointer in the sprites to avoid a lookup (but not a shared one, ownership is with the array...?)
+		/** Floor and ceiling: drawn by the FloorCaster, never uploaded as they are. */
+		std::unordered_map<TextureIndex, ShadedTexture> surfaces;
+
+		/** The effects, loaded whole: short, and they must start at once. */
+		std::unordered_map<SoundIndex, AudioClip> sounds;  //TODO: overkill. Sounds are known at compile time -> use direct addressing array with TextureIndexes... as indexes. Also keep the image pointer in the sprites to avoid a lookup (but not a shared one, ownership is with the array...?)
 
 		UserInterface(const UserInterface&) = delete;
 		void operator=(const UserInterface&) = delete;
 
-		void poll_input();
+		/** With wait_for_input, sleeps until the first event (or IDLE_WAIT_MS) instead of returning at once. */
+		void poll_input(const bool wait_for_input);
+		void handle_event(const SDL_Event& user_input);
+
+		/** A step of the simulation: moves the player as the arrow keys say, for that time. */
+		void move_player(const float seconds);
+		bool movement_keys_held() const;
 
-		/** Cleans the frame buffer, draws the ceiling.
+		/** Cleans the frame buffer, draws the floor and the ceiling.
 		Striclty speaking, this class should only offer primitives to do so, and let the 
 		"game logic" tell it what to draw and when. But since there is NO game logic to 
 		do it and the visual effect is nice, I break the single responsibility principle
-		and "dump" this little bit of graphics here. */
-		void draw_background();
+		and "dump" this little bit of graphics here.
+		
+		The caster fills the whole frame in memory, then it goes to the screen as a single texture. */
+		void draw_background(const FloorCaster& floor_caster, const Camera& camera);
+
+		/** Draws the floor, walls and sprites in the left part of the scene texture, as many columns as the
+		plane has, then shows it. The HUD is drawn afterwards at full resolution.
+		The camera is the one of the player, interpolated between the last two steps of the simulation. */
+		void draw_scene(ProjectionPlane& projection, const FloorCaster& floor_caster, const Camera& camera);
+
+		/** Stretches the last scene drawn to the whole window, without drawing it again. */
+		void show_scene();
 
 		/** Color in red the pixel in the middle of the screen.
 		    This is meant as a debug aid, to see what the player is pointing at. */
 		void draw_debug_crosshair();
 
-		/** Sound being playes in the effects mix channel (or silence). */
-		SoundIndex sfx_sound;
+		/** From the game thread to the audio thread. Nothing else is shared between them: the callback never
+		looks at the world, which the game thread changes while the sound plays. */
+		SpscQueue<AudioCommand, 64> audio_commands;
+
+		/** The last music sent to the audio thread. Game thread only. */
+		SoundIndex published_music;
+
+		/** Music that has the gain now (or silence), the voice of each track and the mixer itself.
+		Audio thread only, once the audio started. */
+		SoundIndex playing_music;
+		std::unordered_map<SoundIndex, AudioMixer::VoiceId> music_voices;
+		AudioMixer mixer;
+
+		/** The music, read from the files while it plays. Pointers: the streams do not move, they are shared
+		by the mixer and the refill thread. The refiller is declared after them, it stops before they go. */
+		std::unordered_map<SoundIndex, std::unique_ptr<MusicStream>> music;
+		std::unique_ptr<StreamRefiller> music_refiller;
+
+		/** Once per frame, on the game thread: tells the audio thread if the music has to change. */
+		void publish_music();
 
 		/** Callback for SDL to pass the sound buffer to play.
 		
@@ -143,7 +220,10 @@ namespace rc {
 		    SDL can use.
 			
 		    The audio queue API does not allow to mix sounds as comfortably as the callback API.
-			The drawback is some low level work on buffers.*/
+			The low level work on buffers is in the AudioMixer.
+
+			It runs on the audio thread: it only takes the commands of the game thread and mixes. A bounded
+			amount of work (at most a queue of commands), no allocations and no locks. */
 		static void audio_callback(void* userdata, Uint8* stream, int len);
 
 		
@@ -96,6 +96,8 @@ int main(int argc, char* args[])
 
 		std::stringstream level_file = fake_file_load();
 		rc::World world = rc::World::load(level_file);
+		std::cout << world.sprites.broad_phase_report() << std::endl;
+		std::cout << world.visibility.report() << std::endl;
 
 		rc::UserInterface ui(world);
 
@@ -112,6 +114,8 @@ int main(int argc, char* args[])
 		ui.set_texture(rc::TextureIndex::FONT, "font.bmp");
 		ui.set_texture(rc::TextureIndex::HUD, "gun.bmp");
 		ui.set_texture(rc::TextureIndex::EXIT, "exit.bmp");
+		ui.set_texture(rc::TextureIndex::FLOOR, "test.bmp");
+		ui.set_texture(rc::TextureIndex::CEILING, "stone_wall.bmp");
 
 		ui.game_loop();
 	}